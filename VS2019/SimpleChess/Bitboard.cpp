@@ -0,0 +1,175 @@
+#include "Bitboard.h"
+
+namespace Chess {
+
+	Bitboard knightAttacksBB[64];
+	Bitboard kingAttacksBB[64];
+	Bitboard pawnAttacksBB[2][64];
+	Magic rookMagics[64];
+	Magic bishopMagics[64];
+	Bitboard betweenBB[64][64];
+	Bitboard lineBB[64][64];
+
+	// all relevant occupancy subsets of every square
+	// rook needs 4096 entries in the corners, bishop at most 512 in the center
+	static Bitboard rookTable[0x19000];
+	static Bitboard bishopTable[0x1480];
+
+	// https://www.chessprogramming.org/Xorshift
+	// fixed seeds per rank find the magics quickly and always the same ones
+	class MagicRandom {
+	private:
+		uint64_t state;
+	public:
+		MagicRandom(uint64_t seed) : state(seed) {}
+
+		uint64_t next() {
+			state ^= state >> 12;
+			state ^= state << 25;
+			state ^= state >> 27;
+			return state * 2685821657736338717ULL;
+		}
+
+		// few set bits make good magic candidates
+		uint64_t sparse() { return next() & next() & next(); }
+	};
+
+	// (file, rank) offsets of the four sliding directions
+	static const int rookSteps[4][2] = { { 0, 1 }, { 0, -1 }, { 1, 0 }, { -1, 0 } };
+	static const int bishopSteps[4][2] = { { 1, 1 }, { 1, -1 }, { -1, 1 }, { -1, -1 } };
+
+	// slow ray walk used only to fill the lookup tables
+	static Bitboard slidingAttacks(const int steps[4][2], int square, Bitboard occupied) {
+		Bitboard attacks = 0;
+
+		for (int i = 0; i < 4; i++) {
+			int file = (square & 7) + steps[i][0];
+			int rank = (square >> 3) + steps[i][1];
+
+			while (file >= 0 && file < 8 && rank >= 0 && rank < 8) {
+				Bitboard b = squareBB(rank * 8 + file);
+				attacks |= b;
+				if (occupied & b)
+					break;
+				file += steps[i][0];
+				rank += steps[i][1];
+			}
+		}
+
+		return attacks;
+	}
+
+	static Bitboard leaperAttacks(const int steps[][2], int count, int square) {
+		Bitboard attacks = 0;
+
+		for (int i = 0; i < count; i++) {
+			int file = (square & 7) + steps[i][0];
+			int rank = (square >> 3) + steps[i][1];
+
+			if (file >= 0 && file < 8 && rank >= 0 && rank < 8)
+				attacks |= squareBB(rank * 8 + file);
+		}
+
+		return attacks;
+	}
+
+	static void initMagics(const int steps[4][2], Magic magics[64], Bitboard* table) {
+		static const uint64_t seeds[8] = { 728, 10316, 55013, 32803, 12281, 15100, 16645, 255 };
+
+		Bitboard occupancy[4096];
+		Bitboard reference[4096];
+		int epoch[4096] = {};
+		int attempt = 0;
+
+		for (int square = 0; square < 64; square++) {
+			Magic& m = magics[square];
+
+			// edge squares do not change the attack set unless the piece stands on that edge
+			Bitboard edges = ((RANK1_BB | RANK8_BB) & ~(RANK1_BB << (8 * (square >> 3)))) |
+				((FILEA_BB | FILEH_BB) & ~(FILEA_BB << (square & 7)));
+
+			m.mask = slidingAttacks(steps, square, 0) & ~edges;
+			m.shift = 64 - popCount(m.mask);
+			m.attacks = square == 0 ? table : magics[square - 1].attacks + (1ULL << (64 - magics[square - 1].shift));
+
+			// carry-rippler enumerates all subsets of the mask
+			int size = 0;
+			Bitboard b = 0;
+			do {
+				occupancy[size] = b;
+				reference[size] = slidingAttacks(steps, square, b);
+				size++;
+				b = (b - m.mask) & m.mask;
+			} while (b);
+
+			MagicRandom random(seeds[square >> 3]);
+
+			for (int i = 0; i < size;) {
+				do {
+					m.magic = random.sparse();
+				} while (popCount((m.magic * m.mask) >> 56) < 6);
+
+				// epoch marks which table entries were written by this attempt
+				// so the table does not have to be cleared after every failure
+				++attempt;
+				for (i = 0; i < size; i++) {
+					unsigned index = m.index(occupancy[i]);
+
+					if (epoch[index] < attempt) {
+						epoch[index] = attempt;
+						m.attacks[index] = reference[i];
+					}
+					else if (m.attacks[index] != reference[i])
+						break;
+				}
+			}
+		}
+	}
+
+	static bool fillTables() {
+		static const int knightSteps[8][2] = {
+			{ 1, 2 }, { -1, 2 }, { 2, 1 }, { -2, 1 }, { 2, -1 }, { -2, -1 }, { 1, -2 }, { -1, -2 }
+		};
+		static const int kingSteps[8][2] = {
+			{ -1, 1 }, { 0, 1 }, { 1, 1 }, { -1, 0 }, { 1, 0 }, { -1, -1 }, { 0, -1 }, { 1, -1 }
+		};
+		static const int whitePawnSteps[2][2] = { { -1, 1 }, { 1, 1 } };
+		static const int blackPawnSteps[2][2] = { { -1, -1 }, { 1, -1 } };
+
+		for (int square = 0; square < 64; square++) {
+			knightAttacksBB[square] = leaperAttacks(knightSteps, 8, square);
+			kingAttacksBB[square] = leaperAttacks(kingSteps, 8, square);
+			pawnAttacksBB[WHITE][square] = leaperAttacks(whitePawnSteps, 2, square);
+			pawnAttacksBB[BLACK][square] = leaperAttacks(blackPawnSteps, 2, square);
+		}
+
+		initMagics(rookSteps, rookMagics, rookTable);
+		initMagics(bishopSteps, bishopMagics, bishopTable);
+
+		for (int a = 0; a < 64; a++)
+			for (int b = 0; b < 64; b++) {
+				betweenBB[a][b] = 0;
+				lineBB[a][b] = 0;
+
+				if (a == b)
+					continue;
+
+				if (bishopAttacks(a, 0) & squareBB(b)) {
+					betweenBB[a][b] = bishopAttacks(a, squareBB(b)) & bishopAttacks(b, squareBB(a));
+					lineBB[a][b] = (bishopAttacks(a, 0) & bishopAttacks(b, 0)) | squareBB(a) | squareBB(b);
+				}
+				else if (rookAttacks(a, 0) & squareBB(b)) {
+					betweenBB[a][b] = rookAttacks(a, squareBB(b)) & rookAttacks(b, squareBB(a));
+					lineBB[a][b] = (rookAttacks(a, 0) & rookAttacks(b, 0)) | squareBB(a) | squareBB(b);
+				}
+			}
+
+		return true;
+	}
+
+	void initBitboards() {
+		// initialization of a function local static is thread safe
+		static bool initialized = fillTables();
+		(void)initialized;
+	}
+}
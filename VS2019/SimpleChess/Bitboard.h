@@ -0,0 +1,121 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include "Types.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Chess {
+
+	// https://www.chessprogramming.org/Bitboards
+	// one bit for every square, a1 = bit 0, h8 = bit 63
+	using Bitboard = uint64_t;
+
+	const Bitboard FILEA_BB = 0x0101010101010101ULL;
+	const Bitboard FILEH_BB = FILEA_BB << 7;
+	const Bitboard RANK1_BB = 0xFFULL;
+	const Bitboard RANK8_BB = RANK1_BB << 56;
+
+	inline Bitboard squareBB(int square) { return 1ULL << square; }
+
+#if defined(_MSC_VER) && defined(_WIN64)
+
+	inline int popCount(Bitboard b) { return (int)__popcnt64(b); }
+
+	inline int lsb(Bitboard b) {
+		unsigned long index;
+		_BitScanForward64(&index, b);
+		return (int)index;
+	}
+
+#elif defined(_MSC_VER)
+
+	inline int popCount(Bitboard b) { return (int)(__popcnt((unsigned)b) + __popcnt((unsigned)(b >> 32))); }
+
+	inline int lsb(Bitboard b) {
+		unsigned long index;
+		if ((unsigned)b) {
+			_BitScanForward(&index, (unsigned)b);
+			return (int)index;
+		}
+		_BitScanForward(&index, (unsigned)(b >> 32));
+		return (int)index + 32;
+	}
+
+#else
+
+	inline int popCount(Bitboard b) { return __builtin_popcountll(b); }
+	inline int lsb(Bitboard b) { return __builtin_ctzll(b); }
+
+#endif
+
+	// index of the least significant set bit, the bit is cleared
+	// b must not be empty
+	inline int popLsb(Bitboard& b) {
+		int square = lsb(b);
+		b &= b - 1;
+		return square;
+	}
+
+	// https://www.chessprogramming.org/Magic_Bitboards
+	// occupancy of the relevant squares multiplied by the magic
+	// gives a perfect hash into the attack table of the square
+	struct Magic {
+		Bitboard mask;
+		Bitboard magic;
+		Bitboard* attacks;
+		int shift;
+
+		unsigned index(Bitboard occupied) const {
+			return (unsigned)(((occupied & mask) * magic) >> shift);
+		}
+	};
+
+	// precomputed attack tables, filled once by initBitboards
+	extern Bitboard knightAttacksBB[64];
+	extern Bitboard kingAttacksBB[64];
+	extern Bitboard pawnAttacksBB[2][64];
+	extern Magic rookMagics[64];
+	extern Magic bishopMagics[64];
+
+	// squares strictly between two squares on the same rank, file or diagonal
+	// empty if the squares are not aligned
+	extern Bitboard betweenBB[64][64];
+
+	// whole rank, file or diagonal going through both squares
+	// empty if the squares are not aligned
+	extern Bitboard lineBB[64][64];
+
+	// safe to call more than once, only the first call fills the tables
+	void initBitboards();
+
+	inline Bitboard rookAttacks(int square, Bitboard occupied) {
+		const Magic& m = rookMagics[square];
+		return m.attacks[m.index(occupied)];
+	}
+
+	inline Bitboard bishopAttacks(int square, Bitboard occupied) {
+		const Magic& m = bishopMagics[square];
+		return m.attacks[m.index(occupied)];
+	}
+
+	// attacked squares of a non pawn piece standing on square
+	inline Bitboard pieceAttacks(int piece, int square, Bitboard occupied) {
+		switch (piece) {
+		case KNIGHT:
+			return knightAttacksBB[square];
+		case BISHOP:
+			return bishopAttacks(square, occupied);
+		case ROOK:
+			return rookAttacks(square, occupied);
+		case QUEEN:
+			return bishopAttacks(square, occupied) | rookAttacks(square, occupied);
+		default:
+			return kingAttacksBB[square];
+		}
+	}
+}
+
+#endif // BITBOARD_H
@@ -2,14 +2,122 @@
 
 namespace Chess {
 
+	// https://www.chessprogramming.org/0x88#Square_Relations
+	// the difference of two 0x88 squares is unique for every direction and distance
+	// indexed by to - from + 119, attackTable holds which pieces can attack
+	// along that difference and stepTable the single step of the ray
+	static int attackTable[240];
+	static int stepTable[240];
+
+	// pawns attack in one direction only, so each color gets its own bit
+	enum AttackMask : int {
+		ATTACKKNIGHT = 1 << KNIGHT,
+		ATTACKBISHOP = 1 << BISHOP,
+		ATTACKROOK = 1 << ROOK,
+		ATTACKQUEEN = 1 << QUEEN,
+		ATTACKKING = 1 << KING,
+		ATTACKWHITEPAWN = 1 << PAWN,
+		ATTACKBLACKPAWN = 1 << (PAWN + 1)
+	};
+
+	// https://www.chessprogramming.org/Zobrist_Hashing
+	// random keys shared by every BoardState, filled once by initZobristHash
+	// 2 colors, 6 piece types, 128 0x88 squares
+	static BoardStateHash piecesHash[2][6][128];
+	static BoardStateHash enpassantHash[128];
+	static BoardStateHash playerColorHash;
+	// for every combination of castling rights
+	static BoardStateHash castlingHash[16];
+
+	// castling rights kept by a move from or to the square
+	// only the king and rook squares take rights away
+	static int castlingMasks[128];
+
+	static bool initZobristHash() {
+		// fixed seed so every run gets the same keys
+		// rand() gives only 15 bits on some platforms which is too few for 64 bit keys
+		std::mt19937_64 random(0);
+
+		for (int i = 0; i < 2; i++) {
+			for (int j = 0; j < 6; j++) {
+				for (int k = 0; k < 128; k++) {
+					piecesHash[i][j][k] = random();
+				}
+			}
+		}
+
+		playerColorHash = random();
+		for (int i = 0; i < 128; i++)
+			enpassantHash[i] = random();
+
+		for (int i = 0; i < 16; i++)
+			castlingHash[i] = random();
+
+		return true;
+	}
+
+	static bool initCastlingMasks() {
+		for (int i = 0; i < 128; i++)
+			castlingMasks[i] = WHITEKINGSIDE | WHITEQUEENSIDE | BLACKKINGSIDE | BLACKQUEENSIDE;
+
+		castlingMasks[x88_H1] &= ~WHITEKINGSIDE;
+		castlingMasks[x88_E1] &= ~(WHITEKINGSIDE | WHITEQUEENSIDE);
+		castlingMasks[x88_A1] &= ~WHITEQUEENSIDE;
+		castlingMasks[x88_H8] &= ~BLACKKINGSIDE;
+		castlingMasks[x88_E8] &= ~(BLACKKINGSIDE | BLACKQUEENSIDE);
+		castlingMasks[x88_A8] &= ~BLACKQUEENSIDE;
+
+		return true;
+	}
+
+	static bool initAttackTable() {
+		static const int knightSteps[8] = {
+			KNIGHTNORTHEAST, KNIGHTNORTHWEST, KNIGHTEASTNORTHEAST, KNIGHTWESTNORTHWEST,
+			KNIGHTEASTSOUTHEAST, KNIGHTWESTSOUTHWEST, KNIGHTSOUTHEAST, KNIGHTSOUTHWEST
+		};
+		static const int diagonalSteps[4] = { NORTHWEST, NORTHEAST, SOUTHWEST, SOUTHEAST };
+		static const int straightSteps[4] = { NORTH, WEST, EAST, SOUTH };
+
+		for (int i = 0; i < 8; i++)
+			attackTable[knightSteps[i] + 119] |= ATTACKKNIGHT;
+
+		for (int i = 0; i < 4; i++) {
+			attackTable[diagonalSteps[i] + 119] |= ATTACKKING;
+			attackTable[straightSteps[i] + 119] |= ATTACKKING;
+
+			for (int distance = 1; distance < 8; distance++) {
+				attackTable[diagonalSteps[i] * distance + 119] |= ATTACKBISHOP | ATTACKQUEEN;
+				stepTable[diagonalSteps[i] * distance + 119] = diagonalSteps[i];
+
+				attackTable[straightSteps[i] * distance + 119] |= ATTACKROOK | ATTACKQUEEN;
+				stepTable[straightSteps[i] * distance + 119] = straightSteps[i];
+			}
+		}
+
+		attackTable[NORTHWEST + 119] |= ATTACKWHITEPAWN;
+		attackTable[NORTHEAST + 119] |= ATTACKWHITEPAWN;
+		attackTable[SOUTHWEST + 119] |= ATTACKBLACKPAWN;
+		attackTable[SOUTHEAST + 119] |= ATTACKBLACKPAWN;
+
+		return true;
+	}
+
 	BoardState::BoardState() {
 
+		initBitboards();
+		initPsqt();
+
+		// initialization of a function local static is thread safe
+		static bool attackTableReady = initAttackTable();
+		static bool zobristReady = initZobristHash();
+		static bool castlingMasksReady = initCastlingMasks();
+		(void)attackTableReady;
+		(void)zobristReady;
+		(void)castlingMasksReady;
+
 		initColors();
 		initPieces();
-		initDirections();
-		initOffset();
-		initSliding();
-		initZobristHash();
+		initBitboardPosition();
 
 		castlingRights = WHITEKINGSIDE | WHITEQUEENSIDE | BLACKKINGSIDE | BLACKQUEENSIDE;
 
@@ -19,360 +127,908 @@ namespace Chess {
 
 		fiftyMoves = 0;
 
-		threefoldRep = false;
+		startPly = 0;
 
-		for (int i = 0; i < 128; i++)
-			for (int j = 0; j < 128; j++)
-				fromToHashTable[i][j] = i * 128 + j;
+		threefoldRep = false;
 
 		whiteKingSquare = x88_E1;
 		blackKingSquare = x88_E8;
 
-		int pawnsSquares[2][8] = {
-			{ x88_A2, x88_B2, x88_C2, x88_D2, x88_E2, x88_F2, x88_G2, x88_H2 }, // WHITE
-			{ x88_A7, x88_B7, x88_C7, x88_D7, x88_E7, x88_F7, x88_G7, x88_H7 }  // BLACK
+		hash = zobristHash();
+		pawnHash = pawnZobristHash();
+
+		// games rarely go over 512 plies, avoid reallocation while playing
+		undoStack.reserve(512);
+		keyStack.reserve(512);
+
+		generateLegalMoves(allPossibleMoves);
+	}
+
+	BoardState::BoardState(const string& fen) : BoardState() {
+		loadFen(fen);
+	}
+
+	BoardState::BoardState(const Position& position) : BoardState() {
+		setPosition(position);
+	}
+
+	void BoardState::getPosition(Position& position) {
+		std::memcpy(position.pieces, piecesBB, sizeof(position.pieces));
+
+		for (int square = 0; square < 64; square++)
+			position.board[square] = (int8_t)pieces[squareToX88(square)];
+
+		position.hash = hash;
+		position.ply = (uint16_t)(startPly + undoStack.size());
+		position.fiftyMoves = (uint16_t)fiftyMoves;
+		position.player = (int8_t)currentPlayer;
+		position.castlingRights = (int8_t)castlingRights;
+		position.enpassantSquare = (int8_t)enpassantSquare;
+	}
+
+	void BoardState::setPosition(const Position& position) {
+		for (int square = 0; square < 64; square++) {
+			int squareIndex = squareToX88(square);
+			int piece = position.board[square];
+
+			pieces[squareIndex] = piece;
+			if (piece == EMPTY)
+				colors[squareIndex] = EMPTY;
+			else if (position.pieces[WHITE][piece] & squareBB(square))
+				colors[squareIndex] = WHITE;
+			else
+				colors[squareIndex] = BLACK;
+		}
+
+		initBitboardPosition();
+
+		currentPlayer = (Color)position.player;
+		castlingRights = position.castlingRights;
+		enpassantSquare = position.enpassantSquare;
+		fiftyMoves = position.fiftyMoves;
+		startPly = position.ply;
+		whiteKingSquare = squareToX88(lsb(piecesBB[WHITE][KING]));
+		blackKingSquare = squareToX88(lsb(piecesBB[BLACK][KING]));
+
+		threefoldRep = false;
+		undoStack.clear();
+		keyStack.clear();
+
+		hash = position.hash;
+		pawnHash = pawnZobristHash();
+		generateLegalMoves(allPossibleMoves);
+	}
+
+	// https://www.chessprogramming.org/Forsyth-Edwards_Notation
+	// the text ends at the first end of line or null character
+	// nothing is allocated, used for bulk loading of position files
+	bool BoardState::loadFen(const char* fen) {
+		int newColors[128];
+		int newPieces[128];
+		int kings[2] = { EMPTY, EMPTY };
+		const char* c = fen;
+
+		auto endOfField = [](char ch) { return ch == ' ' || ch == '\0' || ch == '\n' || ch == '\r'; };
+		auto nextField = [&]() {
+			while (!endOfField(*c))
+				c++;
+			while (*c == ' ')
+				c++;
 		};
 
-		castling.insert({ x88_H1, ~WHITEKINGSIDE });
-		castling.insert({ x88_E1, ~(WHITEKINGSIDE | WHITEQUEENSIDE) });
-		castling.insert({ x88_A1, ~WHITEQUEENSIDE });
-		castling.insert({ x88_H8, ~BLACKKINGSIDE });
-		castling.insert({ x88_E8, ~(BLACKKINGSIDE | BLACKQUEENSIDE) });
-		castling.insert({ x88_A8, ~BLACKQUEENSIDE });
+		for (int s = 0; s < 128; s++) {
+			newColors[s] = EMPTY;
+			newPieces[s] = EMPTY;
+		}
+
+		// piece placement, from a8 to h1
+		for (int rank = RANK8, file = FILEA; !endOfField(*c); c++) {
+			if (*c == '/') {
+				rank--;
+				file = FILEA;
+			}
+			else if (*c >= '1' && *c <= '8')
+				file += *c - '0';
+			else {
+				const char* letters = "nbrqkp";
+				const char* p = strchr(letters, tolower(*c));
+
+				if (!p || !*p || file > FILEH || rank < RANK1)
+					return false;
+
+				int square = rank * 16 + file++;
+				newColors[square] = isupper(*c) ? WHITE : BLACK;
+				newPieces[square] = (int)(p - letters);
+
+				// a pawn on the first or last rank has no moves the generator can handle
+				if (newPieces[square] == PAWN && (rank == RANK1 || rank == RANK8))
+					return false;
+
+				if (newPieces[square] == KING) {
+					if (kings[newColors[square]] != EMPTY)
+						return false;
+					kings[newColors[square]] = square;
+				}
+			}
+		}
+
+		if (kings[WHITE] == EMPTY || kings[BLACK] == EMPTY)
+			return false;
+
+		// side to move, castling rights and enpassant square
+		// missing fields keep their default so "8/8/... w" is accepted
+		nextField();
+		Color side = *c == 'b' ? BLACK : WHITE;
+		nextField();
+
+		int rights = 0;
+		for (; !endOfField(*c); c++)
+			switch (*c) {
+			case 'K': rights |= WHITEKINGSIDE; break;
+			case 'Q': rights |= WHITEQUEENSIDE; break;
+			case 'k': rights |= BLACKKINGSIDE; break;
+			case 'q': rights |= BLACKQUEENSIDE; break;
+			}
+		nextField();
+
+		// the generator expects king and rook on their starting squares for every right
+		auto onSquare = [&](int square, Color color, int piece) { return newColors[square] == color && newPieces[square] == piece; };
+		if (!onSquare(x88_E1, WHITE, KING) || !onSquare(x88_H1, WHITE, ROOK)) rights &= ~WHITEKINGSIDE;
+		if (!onSquare(x88_E1, WHITE, KING) || !onSquare(x88_A1, WHITE, ROOK)) rights &= ~WHITEQUEENSIDE;
+		if (!onSquare(x88_E8, BLACK, KING) || !onSquare(x88_H8, BLACK, ROOK)) rights &= ~BLACKKINGSIDE;
+		if (!onSquare(x88_E8, BLACK, KING) || !onSquare(x88_A8, BLACK, ROOK)) rights &= ~BLACKQUEENSIDE;
+
+		int enpassant = EMPTY;
+		if (c[0] >= 'a' && c[0] <= 'h' && c[1] >= '1' && c[1] <= '8')
+			enpassant = (c[1] - '1') * 16 + (c[0] - 'a');
+		nextField();
+
+		// keep the square only if a double pawn push of the opponent could have left it
+		// the square is empty and the pawn that moved stands right in front of it
+		if (enpassant != EMPTY) {
+			Color opponent = side == WHITE ? BLACK : WHITE;
+			int pawnSquare = enpassant + (side == WHITE ? SOUTH : NORTH);
+
+			if (enpassant >> 4 != (side == WHITE ? RANK6 : RANK3) || newPieces[enpassant] != EMPTY ||
+				!onSquare(pawnSquare, opponent, PAWN))
+				enpassant = EMPTY;
+		}
+
+		// move counters, epd lines have operations here instead and get the defaults
+		int halfmoves = 0, fullmoves = 1;
+		if (isdigit(*c)) {
+			halfmoves = atoi(c);
+			nextField();
+			if (isdigit(*c))
+				fullmoves = std::max(atoi(c), 1);
+		}
+
+		std::memcpy(colors, newColors, sizeof(colors));
+		std::memcpy(pieces, newPieces, sizeof(pieces));
+		initBitboardPosition();
+
+		currentPlayer = side;
+		castlingRights = rights;
+		enpassantSquare = enpassant;
+		fiftyMoves = halfmoves;
+		startPly = (fullmoves - 1) * 2 + (side == BLACK);
+		whiteKingSquare = kings[WHITE];
+		blackKingSquare = kings[BLACK];
+
+		threefoldRep = false;
+		undoStack.clear();
+		keyStack.clear();
 
+		hash = zobristHash();
+		pawnHash = pawnZobristHash();
+		generateLegalMoves(allPossibleMoves);
 
-		allPossibleMoves = generateAllPossibleMoves();
+		return true;
 	}
 
-	// if there are no moves to generate check if king is under check
-	// that signals check mate
-	Moves BoardState::generateAllPossibleMoves() {
+	string BoardState::toFen() {
+		char text[96];
+		char* c = text;
 
-		Color oppositeColor = oppositeSide();
-		Moves generatedMoves;
+		for (int rank = RANK8; rank >= RANK1; rank--) {
+			int empty = 0;
+
+			for (int file = FILEA; file <= FILEH; file++) {
+				int square = rank * 16 + file;
+
+				if (colors[square] == EMPTY) {
+					empty++;
+					continue;
+				}
+
+				if (empty)
+					*c++ = (char)('0' + empty);
+				empty = 0;
+
+				*c++ = pieceToChar((Piece)pieces[square], (Color)colors[square]);
+			}
+
+			if (empty)
+				*c++ = (char)('0' + empty);
+			if (rank > RANK1)
+				*c++ = '/';
+		}
+
+		*c++ = ' ';
+		*c++ = currentPlayer == WHITE ? 'w' : 'b';
+		*c++ = ' ';
+
+		if (castlingRights & WHITEKINGSIDE) *c++ = 'K';
+		if (castlingRights & WHITEQUEENSIDE) *c++ = 'Q';
+		if (castlingRights & BLACKKINGSIDE) *c++ = 'k';
+		if (castlingRights & BLACKQUEENSIDE) *c++ = 'q';
+		if (!castlingRights) *c++ = '-';
+		*c++ = ' ';
 
-		auto pushPromotionMove = [&](int from, int to, int type) -> void {
+		if (enpassantSquare != EMPTY) {
+			*c++ = (char)('a' + getFile(enpassantSquare));
+			*c++ = (char)('1' + getRank(enpassantSquare));
+		}
+		else
+			*c++ = '-';
+
+		int ply = startPly + (int)undoStack.size();
+		snprintf(c, text + sizeof(text) - c, " %d %d", fiftyMoves, ply / 2 + 1);
+
+		return text;
+	}
+
+	void BoardState::pushMove(MoveList& moves, int from, int to, int type) {
+		Move m;
+		m.move.byteData.from = (char)from;
+		m.move.byteData.to = (char)to;
+		m.move.byteData.promote = (char)0;
+		m.move.byteData.type = (char)type;
+
+		// pawn reaching the last rank, one move for every promotion piece
+		if ((type & PAWNPUSH) && (to >= x88_A8 || to <= x88_H1)) {
+			m.move.byteData.type = (char)(type | PROMOTE);
 			for (int p = KNIGHT; p <= QUEEN; p++) {
-				Move m;
-				m.move.byteData.from = (char)from;
-				m.move.byteData.to = (char)to;
 				m.move.byteData.promote = (char)p;
-				m.move.byteData.type = (char)type | PROMOTE;
-				generatedMoves.insert({ fromToHashTable[from][to] , m });
+				moves.push(m);
 			}
-		};
+			return;
+		}
 
-		auto pushMove = [&](int from, int to, int type) -> void {
-			if (type & PAWNPUSH) {
-				if (currentPlayer == WHITE) {
-					if (to >= x88_A8) {
-						pushPromotionMove(from, to, type);
-						return;
-					}
-				}
-				else {
-					if (to <= x88_H1) {
-						pushPromotionMove(from, to, type);
-						return;
-					}
-				}
+		moves.push(m);
+	}
+
+	void BoardState::pushMoves(MoveList& moves, int from, Bitboard targets, int type) {
+		while (targets)
+			pushMove(moves, from, squareToX88(popLsb(targets)), type);
+	}
+
+	// if there are no moves to generate check if king is under check
+	// that signals check mate
+	void BoardState::generateAllPossibleMoves(MoveList& generatedMoves) {
+
+		Color oppositeColor = oppositeSide();
+		generatedMoves.clear();
+
+		Bitboard enemy = colorsBB[oppositeColor];
+		Bitboard empty = ~occupiedBB;
+
+		// PAWNS
+		int forward = currentPlayer == WHITE ? 8 : -8;
+		Bitboard doublePushRank = currentPlayer == WHITE ? RANK1_BB << 8 : RANK1_BB << 48;
+
+		for (Bitboard pawns = piecesBB[currentPlayer][PAWN]; pawns;) {
+			int square = popLsb(pawns);
+			int from = squareToX88(square);
+
+			pushMoves(generatedMoves, from, pawnAttacksBB[currentPlayer][square] & enemy, CAPTURE | PAWNPUSH);
+
+			if (empty & squareBB(square + forward)) {
+				pushMove(generatedMoves, from, squareToX88(square + forward), PAWNPUSH);
+				if ((squareBB(square) & doublePushRank) && (empty & squareBB(square + 2 * forward)))
+					pushMove(generatedMoves, from, squareToX88(square + 2 * forward), PAWNPUSH | PAWNPUSH2);
 			}
-			Move m;
-			m.move.byteData.from = (char)from;
-			m.move.byteData.to = (char)to;
-			m.move.byteData.promote = (char)0;
-			m.move.byteData.type = (char)type;
-			generatedMoves.insert({ fromToHashTable[from][to] , m });
-		};
+		}
 
-		for (int i = 0; i < 128; i++)
-			if (colors[i] == currentPlayer) {
-				// PAWNS
-				if (pieces[i] == PAWN) {
-					if (currentPlayer == WHITE) {
-						if (getFile(i) != FILEA &&
-							colors[i + NORTHWEST] == BLACK)
-							pushMove(i, i + NORTHWEST, CAPTURE | PAWNPUSH);
-						if (getFile(i) != FILEH &&
-							colors[i + NORTHEAST] == BLACK)
-							pushMove(i, i + NORTHEAST, CAPTURE | PAWNPUSH);
-						if (colors[i + NORTH] == EMPTY) {
-							pushMove(i, i + NORTH, PAWNPUSH);
-							if (i >= x88_A2 && colors[i + NORTHNORTH] == EMPTY)
-								pushMove(i, i + NORTHNORTH, PAWNPUSH | PAWNPUSH2);
-						}
-					}
-					else {
-						if (getFile(i) != FILEA &&
-							colors[i + SOUTHWEST] == WHITE)
-							pushMove(i, i + SOUTHWEST, CAPTURE | PAWNPUSH);
-						if (getFile(i) != FILEH &&
-							colors[i + SOUTHEAST] == WHITE)
-							pushMove(i, i + SOUTHEAST, CAPTURE | PAWNPUSH);
-						if (colors[i + SOUTH] == EMPTY) {
-							pushMove(i, i + SOUTH, PAWNPUSH);
-							if (i <= x88_H7 && colors[i + SOUTHSOUTH] == EMPTY)
-								pushMove(i, i + SOUTHSOUTH, PAWNPUSH | PAWNPUSH2);
-						}
-					}
-				}
-				// OTHER PIECES
-				else {
-					for (int j = 0; j < directions[pieces[i]]; j++) {
-						int n = i;
-						while (true) {
-							n = n + offset[pieces[i]][j];
-							
-							if (!validSquareIndex(n))
-								break;
-
-							if (pieces[n] == EMPTY) 
-								pushMove(i, n, NORMALMOVE);
-							else {
-								if (colors[n] == oppositeColor)
-									pushMove(i, n, CAPTURE);
-								break;
-							}
-														
-							if (!sliding[pieces[i]])
-								break;
-						}
-					}
-				}
+		// OTHER PIECES
+		for (int piece = KNIGHT; piece <= KING; piece++) {
+			for (Bitboard bb = piecesBB[currentPlayer][piece]; bb;) {
+				int square = popLsb(bb);
+				Bitboard targets = pieceAttacks(piece, square, occupiedBB);
+
+				pushMoves(generatedMoves, squareToX88(square), targets & enemy, CAPTURE);
+				pushMoves(generatedMoves, squareToX88(square), targets & empty, NORMALMOVE);
 			}
+		}
 
 		// CASTLING MOVES
 		if (currentPlayer == WHITE) {
 			if (castlingRights & WHITEKINGSIDE)
-				pushMove(x88_E1, x88_G1, CASTLE);
+				pushMove(generatedMoves, x88_E1, x88_G1, CASTLE);
 			if (castlingRights & WHITEQUEENSIDE)
-				pushMove(x88_E1, x88_C1, CASTLE);
+				pushMove(generatedMoves, x88_E1, x88_C1, CASTLE);
 		}
 		else {
 			if (castlingRights & BLACKKINGSIDE)
-				pushMove(x88_E8, x88_G8, CASTLE);
+				pushMove(generatedMoves, x88_E8, x88_G8, CASTLE);
 			if (castlingRights & BLACKQUEENSIDE)
-				pushMove(x88_E8, x88_C8, CASTLE);
+				pushMove(generatedMoves, x88_E8, x88_C8, CASTLE);
 		}
 
 		// ENPASSANT MOVES
+		// our pawns that could capture on the enpassant square are exactly
+		// the squares a pawn of the other side standing there would attack
 		if (enpassantSquare != EMPTY) {
+			Bitboard attackers = pawnAttacksBB[oppositeColor][x88ToSquare(enpassantSquare)] & piecesBB[currentPlayer][PAWN];
+			while (attackers)
+				pushMove(generatedMoves, squareToX88(popLsb(attackers)), enpassantSquare, PAWNPUSH | ENPASSANT | CAPTURE);
+		}
+
+	}
+
+	// https://www.chessprogramming.org/Move_Generation#Legal
+	// checkers and pinned pieces are computed once for the position
+	// so no move has to be played to find out if it leaves the king in check
+	void BoardState::generateLegalMoves(MoveList& generatedMoves) {
+		generateLegal(generatedMoves, GENALL);
+	}
+
+	void BoardState::generateLegalCaptures(MoveList& generatedMoves) {
+		generateLegal(generatedMoves, GENCAPTURES);
+	}
+
+	void BoardState::generateLegalQuiets(MoveList& generatedMoves) {
+		generateLegal(generatedMoves, GENQUIETS);
+	}
+
+	void BoardState::generateLegal(MoveList& generatedMoves, GenerationMode mode) {
+
+		Color oppositeColor = oppositeSide();
+		generatedMoves.clear();
+
+		int king = x88ToSquare(getKingSquare(currentPlayer));
+		Bitboard own = colorsBB[currentPlayer];
+		Bitboard enemy = colorsBB[oppositeColor];
+		Bitboard empty = ~occupiedBB;
+		Bitboard checkers = attackersTo(king, occupiedBB) & enemy;
+
+		// captures only, quiet moves have no target squares
+		// pawn pushes are kept for the last rank, promotions change the material too
+		// quiet moves only, the other way round
+		Bitboard captureTargets = mode == GENQUIETS ? 0 : enemy;
+		Bitboard quietTargets = mode == GENCAPTURES ? 0 : empty;
+		Bitboard pushTargets = mode == GENCAPTURES ? empty & (RANK1_BB | RANK8_BB) :
+			mode == GENQUIETS ? empty & ~(RANK1_BB | RANK8_BB) : empty;
+
+		// KING
+		// the king is taken off the board for the attack test
+		// otherwise it would hide the squares behind it on the checking ray
+		Bitboard withoutKing = occupiedBB ^ squareBB(king);
+
+		for (Bitboard targets = kingAttacksBB[king] & (captureTargets | quietTargets); targets;) {
+			int to = popLsb(targets);
+			if (!(attackersTo(to, withoutKing) & enemy))
+				pushMove(generatedMoves, squareToX88(king), squareToX88(to), enemy & squareBB(to) ? CAPTURE : NORMALMOVE);
+		}
+
+		// in double check only the king can move
+		if (checkers & (checkers - 1))
+			return;
+
+		// other pieces have to capture the checking piece or block the check
+		Bitboard checkMask = checkers ? betweenBB[king][lsb(checkers)] | checkers : ~0ULL;
+
+		// pieces pinned to the king can only move along the pin line
+		// a piece is pinned if it is the only one between the king and an enemy slider
+		Bitboard pinned = 0;
+		Bitboard snipers = (rookAttacks(king, 0) & (piecesBB[oppositeColor][ROOK] | piecesBB[oppositeColor][QUEEN])) |
+			(bishopAttacks(king, 0) & (piecesBB[oppositeColor][BISHOP] | piecesBB[oppositeColor][QUEEN]));
+
+		while (snipers) {
+			Bitboard between = betweenBB[king][popLsb(snipers)] & occupiedBB;
+			if (between && !(between & (between - 1)) && (between & own))
+				pinned |= between;
+		}
+
+		// PAWNS
+		int forward = currentPlayer == WHITE ? 8 : -8;
+		Bitboard doublePushRank = currentPlayer == WHITE ? RANK1_BB << 8 : RANK1_BB << 48;
+
+		for (Bitboard pawns = piecesBB[currentPlayer][PAWN]; pawns;) {
+			int square = popLsb(pawns);
+			int from = squareToX88(square);
+			Bitboard allowed = pinned & squareBB(square) ? checkMask & lineBB[king][square] : checkMask;
+
+			pushMoves(generatedMoves, from, pawnAttacksBB[currentPlayer][square] & captureTargets & allowed, CAPTURE | PAWNPUSH);
+
+			if (empty & squareBB(square + forward)) {
+				if (allowed & pushTargets & squareBB(square + forward))
+					pushMove(generatedMoves, from, squareToX88(square + forward), PAWNPUSH);
+				if ((squareBB(square) & doublePushRank) && (quietTargets & allowed & squareBB(square + 2 * forward)))
+					pushMove(generatedMoves, from, squareToX88(square + 2 * forward), PAWNPUSH | PAWNPUSH2);
+			}
+		}
+
+		// OTHER PIECES
+		for (int piece = KNIGHT; piece <= QUEEN; piece++) {
+			for (Bitboard bb = piecesBB[currentPlayer][piece]; bb;) {
+				int square = popLsb(bb);
+				Bitboard targets = pieceAttacks(piece, square, occupiedBB) & ~own & checkMask;
+
+				if (pinned & squareBB(square))
+					targets &= lineBB[king][square];
+
+				pushMoves(generatedMoves, squareToX88(square), targets & captureTargets, CAPTURE);
+				pushMoves(generatedMoves, squareToX88(square), targets & quietTargets, NORMALMOVE);
+			}
+		}
+
+		// CASTLING MOVES
+		// squares between king and rook have to be empty
+		// the king can not castle out of, through or into check
+		if (!checkers && mode != GENCAPTURES) {
+			int rank = currentPlayer == WHITE ? 0 : 56;
+
+			auto pushCastle = [&](int right, int to, Bitboard emptySquares, Bitboard safeSquares) -> void {
+				if (!(castlingRights & right) || (occupiedBB & emptySquares))
+					return;
+				while (safeSquares)
+					if (attackersTo(popLsb(safeSquares), occupiedBB) & enemy)
+						return;
+				pushMove(generatedMoves, getKingSquare(currentPlayer), to, CASTLE);
+			};
+
 			if (currentPlayer == WHITE) {
-				if (getFile(enpassantSquare) != FILEA &&
-					colors[enpassantSquare + SOUTHWEST] == WHITE &&
-					pieces[enpassantSquare + SOUTHWEST] == PAWN)
-						pushMove(enpassantSquare + SOUTHWEST, enpassantSquare, PAWNPUSH | ENPASSANT | CAPTURE);
-				if (getFile(enpassantSquare) != FILEH &&
-					colors[enpassantSquare + SOUTHEAST] == WHITE &&
-					pieces[enpassantSquare + SOUTHEAST] == PAWN)
-						pushMove(enpassantSquare + SOUTHEAST, enpassantSquare, PAWNPUSH | ENPASSANT | CAPTURE);
+				pushCastle(WHITEKINGSIDE, x88_G1, 0x60ULL << rank, 0x60ULL << rank); // f1 g1
+				pushCastle(WHITEQUEENSIDE, x88_C1, 0x0EULL << rank, 0x0CULL << rank); // b1 c1 d1
 			}
 			else {
-				if (getFile(enpassantSquare) != FILEA &&
-					colors[enpassantSquare + NORTHWEST] == BLACK &&
-					pieces[enpassantSquare + NORTHWEST] == PAWN)
-						pushMove(enpassantSquare + NORTHWEST, enpassantSquare, PAWNPUSH | ENPASSANT | CAPTURE);
-				if (getFile(enpassantSquare) != FILEH &&
-					colors[enpassantSquare + NORTHEAST] == BLACK &&
-					pieces[enpassantSquare + NORTHEAST] == PAWN)
-						pushMove(enpassantSquare + NORTHEAST, enpassantSquare, PAWNPUSH | ENPASSANT | CAPTURE);
+				pushCastle(BLACKKINGSIDE, x88_G8, 0x60ULL << rank, 0x60ULL << rank); // f8 g8
+				pushCastle(BLACKQUEENSIDE, x88_C8, 0x0EULL << rank, 0x0CULL << rank); // b8 c8 d8
+			}
+		}
 
+		// ENPASSANT MOVES
+		// two pawns leave the rank of the king at once, so pins do not cover
+		// all the cases, check the king with the occupancy after the capture
+		if (enpassantSquare != EMPTY && mode != GENQUIETS) {
+			int to = x88ToSquare(enpassantSquare);
+			Bitboard captured = squareBB(to - forward);
+			Bitboard attackers = pawnAttacksBB[oppositeColor][to] & piecesBB[currentPlayer][PAWN];
+
+			while (attackers) {
+				int from = popLsb(attackers);
+				Bitboard occupied = (occupiedBB ^ squareBB(from) ^ captured) | squareBB(to);
+
+				if (!(attackersTo(king, occupied) & enemy & ~captured))
+					pushMove(generatedMoves, squareToX88(from), enpassantSquare, PAWNPUSH | ENPASSANT | CAPTURE);
 			}
 		}
 
-		return generatedMoves;
+	}
 
+	Bitboard BoardState::attackersTo(int square, Bitboard occupied) {
+		return (pawnAttacksBB[BLACK][square] & piecesBB[WHITE][PAWN]) |
+			(pawnAttacksBB[WHITE][square] & piecesBB[BLACK][PAWN]) |
+			(knightAttacksBB[square] & (piecesBB[WHITE][KNIGHT] | piecesBB[BLACK][KNIGHT])) |
+			(kingAttacksBB[square] & (piecesBB[WHITE][KING] | piecesBB[BLACK][KING])) |
+			(bishopAttacks(square, occupied) & (piecesBB[WHITE][BISHOP] | piecesBB[BLACK][BISHOP] | piecesBB[WHITE][QUEEN] | piecesBB[BLACK][QUEEN])) |
+			(rookAttacks(square, occupied) & (piecesBB[WHITE][ROOK] | piecesBB[BLACK][ROOK] | piecesBB[WHITE][QUEEN] | piecesBB[BLACK][QUEEN]));
+	}
+
+	BoardStateHash BoardState::pawnZobristHash() {
+		BoardStateHash positionHash = 0;
+
+		for (int color = WHITE; color <= BLACK; color++)
+			for (Bitboard b = piecesBB[color][PAWN]; b;)
+				positionHash ^= piecesHash[color][PAWN][squareToX88(popLsb(b))];
+
+		return positionHash;
 	}
 
 	BoardStateHash BoardState::zobristHash() {
 		BoardStateHash positionHash = 0;
 
-		for (int i = 0; i < 128; i++)
-			if (colors[i] != EMPTY)
-				positionHash ^= piecesHash[colors[i]][pieces[i]][i];
+		// visit only occupied squares through the piece bitboards
+		for (int color = WHITE; color <= BLACK; color++)
+			for (int piece = KNIGHT; piece <= PAWN; piece++)
+				for (Bitboard b = piecesBB[color][piece]; b;)
+					positionHash ^= piecesHash[color][piece][squareToX88(popLsb(b))];
+
 		if (currentPlayer == BLACK)
 			positionHash ^= playerColorHash;
 		if (enpassantSquare != EMPTY)
 			positionHash ^= enpassantHash[enpassantSquare];
+		positionHash ^= castlingHash[castlingRights];
 
 		return positionHash;
 	}
 
-	void BoardState::playMove(Move move) {
-	
-		if (move.move.byteData.type & CASTLE) {
-			int from;
-			int to;
+	IndexPair BoardState::castlingRookMove(int kingTo) {
+		switch (kingTo) {
+		case x88_G1:
+			return IndexPair(x88_H1, x88_F1);
+		case x88_C1:
+			return IndexPair(x88_A1, x88_D1);
+		case x88_G8:
+			return IndexPair(x88_H8, x88_F8);
+		case x88_C8:
+			return IndexPair(x88_A8, x88_D8);
+		default:
+			return IndexPair(EMPTY, EMPTY);
+		}
+	}
 
-			switch (move.move.byteData.to) {
-			case x88_G1:
-				from = x88_H1;
-				to = x88_F1;
-				break;
-			case x88_C1:
-				from = x88_A1;
-				to = x88_D1;
-				break;
-			case x88_G8:
-				from = x88_H8;
-				to = x88_F8;
-				break;
-			case x88_C8:
-				from = x88_A8;
-				to = x88_D8;
-				break;
-			default:
-				break;
+	void BoardState::refreshAccumulator(Accumulator& accumulator, Color perspective) {
+		int kingSquare = x88ToSquare(getKingSquare(perspective));
 
+		network.refresh(accumulator.values[perspective]);
+
+		for (int color = WHITE; color <= BLACK; color++)
+			for (int piece = KNIGHT; piece <= PAWN; piece++) {
+				if (piece == KING)
+					continue;
+
+				Bitboard b = piecesBB[color][piece];
+				while (b)
+					network.addFeature(accumulator.values[perspective], featureIndex(perspective, kingSquare, (Color)color, piece, popLsb(b)));
 			}
-			colors[to] = colors[from];
-			pieces[to] = pieces[from];
-			colors[from] = EMPTY;
-			pieces[from] = EMPTY;
+
+		accumulator.key[perspective] = hash;
+		accumulator.generation[perspective] = network.getGeneration();
+	}
+
+	void BoardState::applyMoveToAccumulator(int ply, Color perspective) {
+		const UndoRecord& undo = undoStack[ply];
+		int from = undo.move.from();
+		int to = undo.move.to();
+		int special = undo.move.special();
+		// side to move alternates, the current player moves at the top of the stack
+		Color mover = ((int)undoStack.size() - ply) % 2 ? oppositeSide() : currentPlayer;
+		Color opponent = mover == WHITE ? BLACK : WHITE;
+		// own king moves are never applied, the king square is the current one
+		int kingSquare = x88ToSquare(getKingSquare(perspective));
+
+		int added[2], removed[2];
+		int addedCount = 0, removedCount = 0;
+
+		// king is not an input, castling moves only the rook
+		if (special == COMPACTCASTLE) {
+			IndexPair rook = castlingRookMove(to);
+			removed[removedCount++] = featureIndex(perspective, kingSquare, mover, ROOK, x88ToSquare(rook.first));
+			added[addedCount++] = featureIndex(perspective, kingSquare, mover, ROOK, x88ToSquare(rook.second));
+		}
+		else if (undo.piece != KING) {
+			int newPiece = special == COMPACTPROMOTE ? undo.move.promote() : undo.piece;
+			removed[removedCount++] = featureIndex(perspective, kingSquare, mover, undo.piece, x88ToSquare(from));
+			added[addedCount++] = featureIndex(perspective, kingSquare, mover, newPiece, x88ToSquare(to));
 		}
 
-		colors[move.move.byteData.to] = currentPlayer;
-		if (move.move.byteData.type & PROMOTE)
-			pieces[move.move.byteData.to] = move.move.byteData.promote;
-		else
-			pieces[move.move.byteData.to] = pieces[move.move.byteData.from];
+		if (undo.captured != EMPTY) {
+			int capturedSquare = special == COMPACTENPASSANT ? to + (mover == WHITE ? SOUTH : NORTH) : to;
+			removed[removedCount++] = featureIndex(perspective, kingSquare, opponent, undo.captured, x88ToSquare(capturedSquare));
+		}
 
-		pieces[move.move.byteData.from] = EMPTY;
-		colors[move.move.byteData.from] = EMPTY;
+		network.update(accumulators[ply].values[perspective], accumulators[ply + 1].values[perspective], added, addedCount, removed, removedCount);
+		accumulators[ply + 1].key[perspective] = hashAtPly(ply + 1);
+		accumulators[ply + 1].generation[perspective] = network.getGeneration();
+	}
 
-		if (move.move.byteData.from == whiteKingSquare)
-			whiteKingSquare = move.move.byteData.to;
-		
-		if (move.move.byteData.from == blackKingSquare)
-			blackKingSquare = move.move.byteData.to;
+	const Accumulator& BoardState::updateAccumulator() {
+		int ply = (int)undoStack.size();
+		uint32_t generation = network.getGeneration();
 
-		int enpassant = currentPlayer == WHITE ? move.move.byteData.to + SOUTH : move.move.byteData.to + NORTH;
+		if ((int)accumulators.size() <= ply)
+			accumulators.resize(ply + 1);
 
-		for (int i = 0; i < 8; i++) {
-			if (pawnsSquares[currentPlayer][i] == move.move.byteData.from) 
-				pawnsSquares[currentPlayer][i] = move.move.byteData.to;
+		for (int perspective = WHITE; perspective <= BLACK; perspective++) {
+			// walk back to the nearest ply computed for this perspective with the current network
+			// a move of the own king changes every input, nothing before it can be reused
+			int start = ply;
+			bool reachable = true;
 
-			if (pawnsSquares[currentPlayer][i] == move.move.byteData.to)
-				pawnsSquares[currentPlayer][i] = EMPTY;
+			while (accumulators[start].key[perspective] != hashAtPly(start) || accumulators[start].generation[perspective] != generation) {
+				Color mover = (ply - (start - 1)) % 2 ? oppositeSide() : currentPlayer;
 
-			if ((move.move.byteData.type & ENPASSANT) && pawnsSquares[currentPlayer][i] == enpassant)
-				pawnsSquares[currentPlayer][i] = EMPTY;
-		}
+				if (start == 0 || (undoStack[start - 1].piece == KING && mover == perspective)) {
+					reachable = false;
+					break;
+				}
 
-		if (move.move.byteData.type & ENPASSANT) {
-			if (currentPlayer == WHITE) {
-				pieces[move.move.byteData.to + SOUTH] = EMPTY;
-				colors[move.move.byteData.to + SOUTH] = EMPTY;
+				start--;
 			}
-			else {
-				pieces[move.move.byteData.to + NORTH] = EMPTY;
-				colors[move.move.byteData.to + NORTH] = EMPTY;
+
+			if (!reachable) {
+				refreshAccumulator(accumulators[ply], (Color)perspective);
+				continue;
 			}
 
+			for (int i = start; i < ply; i++)
+				applyMoveToAccumulator(i, (Color)perspective);
 		}
-		
-		if(castling.find(move.move.byteData.from) != castling.end())
-			castlingRights &= castling.at(move.move.byteData.from);
 
-		if (castling.find(move.move.byteData.to) != castling.end())
-			castlingRights &= castling.at(move.move.byteData.to);
+		return accumulators[ply];
+	}
 
+	void BoardState::playMove(Move move) {
+		int from = move.move.byteData.from;
+		int to = move.move.byteData.to;
+		int type = move.move.byteData.type;
+		int piece = pieces[from];
+		Color attackedSide = oppositeSide();
+
+		// square of the captured piece, differs from the target only for enpassant
+		int capturedSquare = type & ENPASSANT ? to + (currentPlayer == WHITE ? SOUTH : NORTH) : to;
+
+		UndoRecord undo;
+		undo.move = CompactMove(move);
+		undo.piece = piece;
+		undo.captured = type & CAPTURE ? pieces[capturedSquare] : EMPTY;
+		undo.castlingRights = castlingRights;
+		undo.enpassantSquare = enpassantSquare;
+		undo.fiftyMoves = fiftyMoves;
+		undo.whiteKingSquare = whiteKingSquare;
+		undo.blackKingSquare = blackKingSquare;
+		undoStack.push_back(undo);
+		keyStack.push_back(hash);
+		updatePawnHash(undo, currentPlayer);
+
+		// remove the old enpassant and castling keys from the hash
+		// new ones are added once they are updated
+		if (enpassantSquare != EMPTY)
+			hash ^= enpassantHash[enpassantSquare];
+		hash ^= castlingHash[castlingRights];
 
-		/*switch (move.move.byteData.from) {
-		case x88_H1:
-			castlingRights &= ~WHITEKINGSIDE;
-			break;
-		case x88_E1:
-			castlingRights &= ~(WHITEKINGSIDE | WHITEQUEENSIDE);
-			break;
-		case x88_A1:
-			castlingRights &= ~WHITEQUEENSIDE;
-			break;
-		case x88_H8:
-			castlingRights &= ~BLACKKINGSIDE;
-			break;
-		case x88_E8:
-			castlingRights &= ~(BLACKKINGSIDE | BLACKQUEENSIDE);
-			break;
-		case x88_A8:
-			castlingRights &= ~BLACKQUEENSIDE;
-			break;
-		default:
-			break;
+		if (type & CAPTURE) {
+			hash ^= piecesHash[attackedSide][pieces[capturedSquare]][capturedSquare];
+			removePiece(capturedSquare);
 		}
 
-		switch (move.move.byteData.to) {
-		case x88_H1:
-			castlingRights &= ~WHITEKINGSIDE;
-			break;
-		case x88_E1:
-			castlingRights &= ~(WHITEKINGSIDE | WHITEQUEENSIDE);
-			break;
-		case x88_A1:
-			castlingRights &= ~WHITEQUEENSIDE;
-			break;
-		case x88_H8:
-			castlingRights &= ~BLACKKINGSIDE;
-			break;
-		case x88_E8:
-			castlingRights &= ~(BLACKKINGSIDE | BLACKQUEENSIDE);
-			break;
-		case x88_A8:
-			castlingRights &= ~BLACKQUEENSIDE;
-			break;
-		default:
-			break;
-		}*/
+		// move the rook
+		// king is moved later
+		if (type & CASTLE) {
+			IndexPair rook = castlingRookMove(to);
+			hash ^= piecesHash[currentPlayer][ROOK][rook.first] ^ piecesHash[currentPlayer][ROOK][rook.second];
+			movePiece(rook.first, rook.second);
+		}
 
-		if (move.move.byteData.type & PAWNPUSH2) {
+		if (type & PROMOTE) {
+			removePiece(from);
+			putPiece(currentPlayer, move.move.byteData.promote, to);
+		}
+		else
+			movePiece(from, to);
+
+		hash ^= piecesHash[currentPlayer][piece][from] ^ piecesHash[currentPlayer][pieces[to]][to];
+
+		if (from == whiteKingSquare)
+			whiteKingSquare = to;
+		
+		if (from == blackKingSquare)
+			blackKingSquare = to;
+		
+		castlingRights &= castlingMasks[from] & castlingMasks[to];
+
+		if (type & PAWNPUSH2) {
 			if (currentPlayer == WHITE)
-				enpassantSquare = move.move.byteData.to + SOUTH;
+				enpassantSquare = to + SOUTH;
 			else
-				enpassantSquare = move.move.byteData.to + NORTH;
+				enpassantSquare = to + NORTH;
 		}
 		else
 			enpassantSquare = EMPTY;
 
-		if (move.move.byteData.type & (PAWNPUSH | CAPTURE))
+		if (enpassantSquare != EMPTY)
+			hash ^= enpassantHash[enpassantSquare];
+		hash ^= castlingHash[castlingRights];
+
+		if (type & (PAWNPUSH | CAPTURE))
 			fiftyMoves = 0;
 		else
 			++fiftyMoves;
 
-		BoardStateHash hash = zobristHash();
+		currentPlayer = attackedSide;
+		hash ^= playerColorHash;
+
+	}
+
+	void BoardState::updatePawnHash(const UndoRecord& undo, Color mover) {
+		int from = undo.move.from();
+		int to = undo.move.to();
+		int special = undo.move.special();
 
-		auto value = history.find(hash);
-		// found the same position
-		if (value != history.end()) {
-			value->second++;
-			if (value->second >= 2)
-				threefoldRep = true;
+		// a promoted pawn leaves the pawn structure
+		if (undo.piece == PAWN) {
+			pawnHash ^= piecesHash[mover][PAWN][from];
+			if (special != COMPACTPROMOTE)
+				pawnHash ^= piecesHash[mover][PAWN][to];
 		}
-		else // first time seeing this position
-			history.insert({ hash, 0 }); // insert new position with zero repetitions
 
+		if (undo.captured == PAWN) {
+			int capturedSquare = special == COMPACTENPASSANT ? to + (mover == WHITE ? SOUTH : NORTH) : to;
+			pawnHash ^= piecesHash[mover == WHITE ? BLACK : WHITE][PAWN][capturedSquare];
+		}
 	}
 
-	bool BoardState::testPseudoLegalMove(Move move) {
+	void BoardState::unmakeMove() {
+		UndoRecord& undo = undoStack.back();
+
+		int from = undo.move.from();
+		int to = undo.move.to();
+		int special = undo.move.special();
+
+		currentPlayer = oppositeSide();
+		Color attackedSide = oppositeSide();
+		updatePawnHash(undo, currentPlayer);
+
+		int capturedSquare = special == COMPACTENPASSANT ? to + (currentPlayer == WHITE ? SOUTH : NORTH) : to;
+
+		if (special == COMPACTPROMOTE) {
+			removePiece(to);
+			putPiece(currentPlayer, PAWN, from);
+		}
+		else
+			movePiece(to, from);
+
+		if (special == COMPACTCASTLE) {
+			IndexPair rook = castlingRookMove(to);
+			movePiece(rook.second, rook.first);
+		}
+
+		if (undo.captured != EMPTY)
+			putPiece(attackedSide, undo.captured, capturedSquare);
+
+		castlingRights = undo.castlingRights;
+		enpassantSquare = undo.enpassantSquare;
+		fiftyMoves = undo.fiftyMoves;
+		whiteKingSquare = undo.whiteKingSquare;
+		blackKingSquare = undo.blackKingSquare;
+		hash = keyStack.back();
+
+		undoStack.pop_back();
+		keyStack.pop_back();
+	}
+
+	bool BoardState::isRepetition(int count) {
+		int size = (int)keyStack.size();
+		// a capture or pawn move can not be undone, older positions never come back
+		// the fen may count moves that were not played on this board
+		int oldest = std::max(size - fiftyMoves, 0);
+
+		// the same side has to be to move, so only every second position
+		for (int i = size - 2; i >= oldest; i -= 2)
+			if (keyStack[i] == hash && --count == 0)
+				return true;
+
+		return false;
+	}
+
+	bool BoardState::pieceAttacksSquare(int from, int to) {
+		int index = to - from + 119;
+		int piece = pieces[from];
+		int mask = piece == PAWN ? (colors[from] == WHITE ? ATTACKWHITEPAWN : ATTACKBLACKPAWN) : 1 << piece;
+
+		// the piece can not reach the square at all
+		if (!(attackTable[index] & mask))
+			return false;
+
+		// sliding pieces need an empty ray, leapers are done
+		if (piece == BISHOP || piece == ROOK || piece == QUEEN) {
+			int step = stepTable[index];
+			for (int square = from + step; square != to; square += step)
+				if (colors[square] != EMPTY)
+					return false;
+		}
+
+		return true;
+	}
+
+	bool BoardState::isPseudoLegal(Move move) {
+		int from = move.move.byteData.from;
+		int to = move.move.byteData.to;
+		int type = move.move.byteData.type;
+
+		if (!validSquareIndex(from) || !validSquareIndex(to) || from == to)
+			return false;
+
+		if (colors[from] != currentPlayer)
+			return false;
 
-		int tempColors[128];
-		std::memcpy(tempColors, colors, sizeof(colors));
+		int piece = pieces[from];
 
-		int tempPieces[128];
-		std::memcpy(tempPieces, pieces, sizeof(pieces));
+		// squares between king and rook and attacks on them
+		// are tested by testPseudoLegalMove
+		if (type & CASTLE) {
+			if (type != CASTLE || piece != KING)
+				return false;
+			switch (to) {
+			case x88_G1:
+				return from == x88_E1 && (castlingRights & WHITEKINGSIDE);
+			case x88_C1:
+				return from == x88_E1 && (castlingRights & WHITEQUEENSIDE);
+			case x88_G8:
+				return from == x88_E8 && (castlingRights & BLACKKINGSIDE);
+			case x88_C8:
+				return from == x88_E8 && (castlingRights & BLACKQUEENSIDE);
+			default:
+				return false;
+			}
+		}
+
+		// the generator marks every pawn move with PAWNPUSH
+		if (((type & PAWNPUSH) != 0) != (piece == PAWN))
+			return false;
+
+		if (type & ENPASSANT)
+			return type == (PAWNPUSH | ENPASSANT | CAPTURE) && to == enpassantSquare && pieceAttacksSquare(from, to);
 
-		int tempPawns[2][8];
-		std::memcpy(tempPawns, colors, sizeof(pawnsSquares));
+		if (type & CAPTURE) {
+			if (colors[to] != oppositeSide())
+				return false;
+		}
+		else if (colors[to] != EMPTY)
+			return false;
 
-		int tempBlackKing = blackKingSquare;
-		int tempWhiteKing = whiteKingSquare;
+		if (piece != PAWN)
+			return !(type & ~CAPTURE) && pieceAttacksSquare(from, to);
+
+		// pawn reaching the last rank has to promote
+		bool lastRank = getRank(to) == (currentPlayer == WHITE ? RANK8 : RANK1);
+		if (lastRank != ((type & PROMOTE) != 0))
+			return false;
+		if ((type & PROMOTE) && (move.move.byteData.promote < KNIGHT || move.move.byteData.promote > QUEEN))
+			return false;
+
+		if (type & CAPTURE)
+			return !(type & PAWNPUSH2) && pieceAttacksSquare(from, to);
+
+		int forward = currentPlayer == WHITE ? NORTH : SOUTH;
+
+		if (type & PAWNPUSH2)
+			return getRank(from) == (currentPlayer == WHITE ? RANK2 : RANK7) &&
+				to == from + 2 * forward && colors[from + forward] == EMPTY;
+
+		return to == from + forward;
+	}
+
+	Move BoardState::decodeMove(CompactMove compact) {
+		int from = compact.from();
+		int to = compact.to();
+		Move move = Move();
+		int type = NORMALMOVE;
+
+		move.move.byteData.from = (char)from;
+		move.move.byteData.to = (char)to;
+
+		switch (compact.special()) {
+		case COMPACTCASTLE:
+			type = CASTLE;
+			break;
+		case COMPACTENPASSANT:
+			type = PAWNPUSH | ENPASSANT | CAPTURE;
+			break;
+		default:
+			if (colors[to] != EMPTY)
+				type |= CAPTURE;
+			if (pieces[from] == PAWN)
+				type |= std::abs(to - from) == 2 * NORTH ? PAWNPUSH | PAWNPUSH2 : PAWNPUSH;
+			if (compact.special() == COMPACTPROMOTE) {
+				type |= PROMOTE;
+				move.move.byteData.promote = (char)compact.promote();
+			}
+		}
+
+		move.move.byteData.type = (char)type;
+		return move;
+	}
+
+	bool BoardState::testPseudoLegalMove(Move move) {
 
 		Color attackingSide = oppositeSide();
 
-		// move the rook
-		// king is moved later
+		// castling squares have to be empty and not attacked
+		// the rook and the king are moved by playMove
 		if (move.move.byteData.type & CASTLE) {
-			int from;
-			int to;
 
 			if (kingInCheck())
 				return false;
@@ -383,8 +1039,6 @@ namespace Chess {
 					squareUnderAttack(x88_F1, attackingSide) ||
 					squareUnderAttack(x88_G1, attackingSide))
 					return false;
-				from = x88_H1;
-				to = x88_F1;
 				break;
 			case x88_C1:
 				if (colors[x88_B1] != EMPTY || colors[x88_C1] != EMPTY
@@ -392,16 +1046,12 @@ namespace Chess {
 					squareUnderAttack(x88_C1, attackingSide) ||
 					squareUnderAttack(x88_D1, attackingSide))
 					return false;
-				from = x88_A1;
-				to = x88_D1;
 				break;
 			case x88_G8:
 				if (colors[x88_F8] != EMPTY || colors[x88_G8] != EMPTY ||
 					squareUnderAttack(x88_F8, attackingSide) ||
 					squareUnderAttack(x88_G8, attackingSide))
 					return false;
-				from = x88_H8;
-				to = x88_F8;
 				break;
 			case x88_C8:
 				if (colors[x88_B8] != EMPTY || colors[x88_C8] != EMPTY ||
@@ -409,89 +1059,29 @@ namespace Chess {
 					squareUnderAttack(x88_C8, attackingSide) ||
 					squareUnderAttack(x88_D8, attackingSide))
 					return false;
-				from = x88_A8;
-				to = x88_D8;
 				break;
 			default:
 				break;
 
 			}
-			colors[to] = colors[from];
-			pieces[to] = pieces[from];
-			colors[from] = EMPTY;
-			pieces[from] = EMPTY;
-		}
-
-		colors[move.move.byteData.to] = currentPlayer;
-		if (move.move.byteData.type & PROMOTE)
-			pieces[move.move.byteData.to] = move.move.byteData.promote;
-		else
-			pieces[move.move.byteData.to] = pieces[move.move.byteData.from];
-		
-		pieces[move.move.byteData.from] = EMPTY;
-		colors[move.move.byteData.from] = EMPTY;
-
-		if (move.move.byteData.type & ENPASSANT) {
-			if (currentPlayer == WHITE) {
-				pieces[move.move.byteData.to + SOUTH] = EMPTY;
-				colors[move.move.byteData.to + SOUTH] = EMPTY;
-			}
-			else {
-				pieces[move.move.byteData.to + NORTH] = EMPTY;
-				colors[move.move.byteData.to + NORTH] = EMPTY;
-			}
 		}
 
-		if (move.move.byteData.from == whiteKingSquare)
-			whiteKingSquare = move.move.byteData.to;
-
-		if (move.move.byteData.from == blackKingSquare)
-			blackKingSquare = move.move.byteData.to;
-
-		int enpassant = currentPlayer == WHITE ? move.move.byteData.to + SOUTH : move.move.byteData.to + NORTH;
-
-		for (int i = 0; i < 8; i++) {
-			if (pawnsSquares[currentPlayer][i] == move.move.byteData.from)
-				pawnsSquares[currentPlayer][i] = move.move.byteData.to;
-
-			if (pawnsSquares[currentPlayer][i] == move.move.byteData.to)
-				pawnsSquares[currentPlayer][i] = EMPTY;
+		playMove(move);
 
-			if ((move.move.byteData.type & ENPASSANT) && pawnsSquares[currentPlayer][i] == enpassant)
-				pawnsSquares[currentPlayer][i] = EMPTY;
-		}
-
-		// if the king is in check after making a move
+		// if the king of the side that moved is in check
 		// signal invalid move
-		bool inCheck = false;
-
-		if (kingInCheck())
-			inCheck = true;
-
-		// restore the state back
-		std::memcpy(colors, tempColors, sizeof(colors));
-		std::memcpy(pieces, tempPieces, sizeof(pieces));
-
-		std::memcpy(pawnsSquares, tempPawns, sizeof(pawnsSquares));
+		int king = currentPlayer == WHITE ? blackKingSquare : whiteKingSquare;
+		bool inCheck = squareUnderAttack(king, currentPlayer);
 
-		blackKingSquare = tempBlackKing;	
-		whiteKingSquare = tempWhiteKing;
+		unmakeMove();
 
-		if (inCheck)
-			return false;
-		
-		return true;
+		return !inCheck;
 
 	}
 
 	GameStatus BoardState::gameStatus() {
-		bool noValidMove = true;
-
-		for(auto& move : allPossibleMoves)
-			if (testPseudoLegalMove(move.second)) {
-				noValidMove = false;
-				break;
-			}
+		// all possible moves are legal moves
+		bool noValidMove = allPossibleMoves.empty();
 
 		if (noValidMove)
 			if (kingInCheck())
@@ -516,106 +1106,26 @@ namespace Chess {
 		
 	}
 
-	bool BoardState::underAttackByKing(int squareIndex, Color attackingSide) {
-		int attackingSquare;
-		for (int i = 0; i < 8; i++) {
-			attackingSquare = squareIndex + offset[KING][i];
-			if (validSquareIndex(attackingSquare)
-				&& pieces[attackingSquare] == KING
-				&& colors[attackingSquare] == attackingSide)
-				return true;
-		}
-		return false;
-	}
-
-	bool BoardState::underAttackByKnight(int squareIndex, Color attackingSide) {
-		int attackingSquare;
-		for (int i = 0; i < 8; i++) {
-			attackingSquare = squareIndex + offset[KNIGHT][i];
-			if (validSquareIndex(attackingSquare)
-				&& pieces[attackingSquare] == KNIGHT
-				&& colors[attackingSquare] == attackingSide)
-				return true;
-		}
-		return false;
-	}
-
-	bool BoardState::underAttackByBishopOrQueen(int squareIndex, Color attackingSide) {
-	
-		auto checkRoutine = [&](Direction direction) -> bool {
-			int attackingSquare = squareIndex + direction;
-
-			while (validSquareIndex(attackingSquare)) {
-				if (colors[attackingSquare] != EMPTY) {
-					if ((colors[attackingSquare] == attackingSide)
-						&& (pieces[attackingSquare] == BISHOP || pieces[attackingSquare] == QUEEN))
-						return true;
-					return false;
-				}
-				attackingSquare += direction;
-			}
-
-			return false;
-		};
-
-		return checkRoutine(NORTHEAST) || checkRoutine(SOUTHEAST) || checkRoutine(SOUTHWEST) || checkRoutine(NORTHWEST);
-	
-	}
-
-	bool BoardState::underAttackByRookOrQueen(int squareIndex, Color attackingSide) {
-		
-		auto checkRoutine = [&](Direction direction) -> bool {
-			int attackingSquare = squareIndex + direction;
-
-			while (validSquareIndex(attackingSquare)) {
-				if (colors[attackingSquare] != EMPTY) {
-					if ((colors[attackingSquare] == attackingSide)
-						&& (pieces[attackingSquare] == ROOK || pieces[attackingSquare] == QUEEN))
-						return true;
-					return false;
-				}
-				attackingSquare += direction;
-			}
+	bool BoardState::squareUnderAttack(int squareIndex, Color attackingSide) {
+		int square = x88ToSquare(squareIndex);
+		const Bitboard* attackers = piecesBB[attackingSide];
 
-			return false;
-		};
-		
-		return checkRoutine(NORTH) || checkRoutine(SOUTH) || checkRoutine(EAST) || checkRoutine(WEST);
-		
-	}
+		// pawns attacking the square stand where a pawn of the
+		// defending side on that square would capture
+		if (pawnAttacksBB[attackingSide == WHITE ? BLACK : WHITE][square] & attackers[PAWN])
+			return true;
 
-	bool BoardState::squareUnderAttack(int squareIndex, Color attackingSide) {
-		// PAWNS
-		for (int i = 0; i < 8; i++) {
-			if (pawnsSquares[attackingSide][i] != EMPTY) {
-				int square = pawnsSquares[attackingSide][i];
-				if (attackingSide == WHITE) {
-					if (getFile(square) != FILEA &&
-						square + NORTHWEST == squareIndex)
-						return true;
-					if (getFile(square) != FILEH &&
-						square + NORTHEAST == squareIndex)
-						return true;
-				}
-				else {
-					if (getFile(square) != FILEA &&
-						square + SOUTHWEST == squareIndex)
-						return true;
-					if (getFile(square) != FILEH &&
-						square + SOUTHEAST == squareIndex)
-						return true;
+		if (knightAttacksBB[square] & attackers[KNIGHT])
+			return true;
 
-				}
-			}
-		}
+		if (kingAttacksBB[square] & attackers[KING])
+			return true;
 
-		// OTHER PIECES
+		if (bishopAttacks(square, occupiedBB) & (attackers[BISHOP] | attackers[QUEEN]))
+			return true;
 
-		if (underAttackByKing(squareIndex, attackingSide)			||
-		   (underAttackByKnight(squareIndex, attackingSide))		||
-		   (underAttackByBishopOrQueen(squareIndex, attackingSide)) ||
-		   (underAttackByRookOrQueen(squareIndex, attackingSide)))
-				return true;
+		if (rookAttacks(square, occupiedBB) & (attackers[ROOK] | attackers[QUEEN]))
+			return true;
 
 		return false;
 
@@ -652,82 +1162,33 @@ namespace Chess {
 		std::memcpy(pieces, tempPieces, sizeof(pieces));
 	}
 
-	void BoardState::initDirections() {
-		int tempDirections[5] = {
-			8, //KNIGHT
-			4, //BISHOP
-			4, //ROOK
-			8, //QUEEN
-			8  //KING
-		};
-
-		std::memcpy(directions, tempDirections, sizeof(directions));
-	}
-
-	void BoardState::initOffset() {
-		int tempOffset[5][8] = {
-			{ KNIGHTNORTHEAST, KNIGHTNORTHWEST, KNIGHTEASTNORTHEAST, KNIGHTWESTNORTHWEST,
-			  KNIGHTEASTSOUTHEAST, KNIGHTWESTSOUTHWEST, KNIGHTSOUTHEAST, KNIGHTSOUTHWEST }, // KNIGHT
-			{ NORTHWEST, NORTHEAST, SOUTHWEST, SOUTHEAST, 0, 0, 0, 0 },						// BISHOP
-			{ NORTH, WEST, EAST, SOUTH, 0, 0, 0, 0 },										// ROOK
-			{ NORTHWEST, NORTH, NORTHEAST, WEST, EAST, SOUTHWEST, SOUTH, SOUTHEAST },		// QUEEN
-			{ NORTHWEST, NORTH, NORTHEAST, WEST, EAST, SOUTHWEST, SOUTH, SOUTHEAST }		// KING
-		};
-
-		std::memcpy(offset, tempOffset, sizeof(offset));
-	}
-
-	void BoardState::initSliding() {
-		static bool tempSliding[5] = {
-			false, // KNIGHT
-			true,  // BISHOP
-			true,  // ROOK
-			true,  // QUEEN
-			false  // KING
-		};
-
-		std::memcpy(sliding, tempSliding, sizeof(sliding));
-	}
-
-	void BoardState::initZobristHash() {
-		srand(0);
+	void BoardState::initBitboardPosition() {
+		std::memset(piecesBB, 0, sizeof(piecesBB));
+		std::memset(colorsBB, 0, sizeof(colorsBB));
+		occupiedBB = 0;
+		mgScore = egScore = phase = 0;
 
-		auto random = []() -> BoardStateHash {
-			BoardStateHash value = 0;
-
-			for (int i = 0; i < sizeof(BoardStateHash); i++)
-				value ^= rand() << i;
-
-			return value;
-		};
-
-		for (int i = 0; i < 2; i++) {
-			for (int j = 0; j < 6; j++) {
-				for (int k = 0; k < 128; k++) {
-					piecesHash[i][j][k] = random();
-				}
-			}
-		}
-
-		playerColorHash = random();
 		for (int i = 0; i < 128; i++)
-			enpassantHash[i] = random();
-
+			if (validSquareIndex(i) && colors[i] != EMPTY) {
+				int square = x88ToSquare(i);
+				Bitboard b = squareBB(square);
+				piecesBB[colors[i]][pieces[i]] |= b;
+				colorsBB[colors[i]] |= b;
+				occupiedBB |= b;
+				mgScore += psqtMg[colors[i]][pieces[i]][square];
+				egScore += psqtEg[colors[i]][pieces[i]][square];
+				phase += phaseWeights[pieces[i]];
+			}
 	}
 
 	GameStatus BoardState::playNextMove(ValidMove move, GameStatus previousGameStateStatus) {
 
 		threefoldRep = false;
 
-		// if there is a move it still needs to be checked
-		// after playing it the king could be in check which is invalid
-		// but first check if the move supplied is valid
+		// findMove only finds moves from the legal move list
+		// so a found move does not have to be tested again
 		
-		if (move.first) {
-			if (!testPseudoLegalMove(move.second))
-				return INVALIDMOVE;
-		}
-		else
+		if (!move.first)
 			return INVALIDMOVE;
 
 		// move is valid
@@ -736,9 +1197,10 @@ namespace Chess {
 
 		// move to next state
 
-		currentPlayer = oppositeSide();
 		allPossibleMoves.clear();
 
+		threefoldRep = isRepetition(2);
+
 		// every time if it is discovered that any position repeats again (min 3 times)
 		// prompt the player if he wants to claim draw
 		if (threefoldRep)
@@ -752,22 +1214,117 @@ namespace Chess {
 		ValidMove valid;
 
 		valid.first = false;
-		valid.second = Move{ -1, -1 };
+		valid.second = NOMOVE;
 
 		if (fromToPair.first < 0 || fromToPair.second < 0 ||
 			fromToPair.first > 127 || fromToPair.second > 127)
 			return valid;
 
-		auto value = allPossibleMoves.find(fromToHashTable[fromToPair.first][fromToPair.second]);
+		// the list is short and contiguous so a linear scan is enough
+		// for promotions the first of the four moves is returned
+		// and the caller picks the promotion piece
+		for (auto& move : allPossibleMoves)
+			if (move.move.byteData.from == fromToPair.first &&
+				move.move.byteData.to == fromToPair.second) {
+				valid.first = true;
+				valid.second = move;
+				break;
+			}
+
+		return valid;
+
+	}
 
-		// if move is found
-		if (value != allPossibleMoves.end()) {
-			valid.first = true;
-			valid.second = value->second;
+	// https://www.chessprogramming.org/Algebraic_Chess_Notation#SAN
+	ValidMove BoardState::findSanMove(const char* san, size_t length) {
+		ValidMove valid;
+
+		valid.first = false;
+		valid.second = NOMOVE;
+
+		// check, mate and annotation marks are not needed to find the move
+		while (length > 0 && strchr("+#!?", san[length - 1]))
+			length--;
+
+		if (length < 2)
+			return valid;
+
+		// O-O, O-O-O, also written with zeros
+		if (san[0] == 'O' || san[0] == '0') {
+			int kingFile = length >= 5 ? FILEC : FILEG;
+
+			for (auto& move : allPossibleMoves)
+				if ((move.move.byteData.type & CASTLE) && getFile(move.move.byteData.to) == kingFile) {
+					valid.first = true;
+					valid.second = move;
+				}
+
+			return valid;
 		}
 
-		return valid;
+		int piece = PAWN;
+		const char* letters = "NBRQK";
+		const char* found = strchr(letters, san[0]);
+
+		if (found && *found) {
+			piece = (int)(found - letters);
+			san++;
+			length--;
+		}
+
+		// promotion piece at the end, e8=Q or e8Q
+		int promote = EMPTY;
+		if (piece == PAWN && length > 2) {
+			found = strchr(letters, san[length - 1]);
+			if (found && *found && *found != 'K') {
+				promote = (int)(found - letters);
+				length -= san[length - 2] == '=' ? 2 : 1;
+			}
+		}
 
+		if (length < 2 || san[length - 2] < 'a' || san[length - 2] > 'h' || san[length - 1] < '1' || san[length - 1] > '8')
+			return valid;
+
+		int to = (san[length - 1] - '1') * 16 + (san[length - 2] - 'a');
+
+		// whatever is left before the target square tells the from square apart
+		int fromFile = EMPTY, fromRank = EMPTY;
+		for (size_t i = 0; i + 2 < length; i++) {
+			if (san[i] >= 'a' && san[i] <= 'h')
+				fromFile = san[i] - 'a';
+			else if (san[i] >= '1' && san[i] <= '8')
+				fromRank = san[i] - '1';
+		}
+
+		int matches = 0;
+
+		for (auto& move : allPossibleMoves) {
+			int from = move.move.byteData.from;
+
+			if (move.move.byteData.to != to || pieces[from] != piece || (move.move.byteData.type & CASTLE))
+				continue;
+			if ((fromFile != EMPTY && getFile(from) != fromFile) || (fromRank != EMPTY && getRank(from) != fromRank))
+				continue;
+			// pawn captures always name the file the pawn comes from
+			if (piece == PAWN && fromFile == EMPTY && (move.move.byteData.type & CAPTURE))
+				continue;
+
+			// promotions are listed once for every piece
+			if (move.move.byteData.type & PROMOTE) {
+				if (move.move.byteData.promote != (promote == EMPTY ? QUEEN : promote))
+					continue;
+			}
+			else if (promote != EMPTY)
+				continue;
+
+			valid.second = move;
+			matches++;
+		}
+
+		// an ambiguous move is as wrong as a missing one
+		valid.first = matches == 1;
+
+		return valid;
 	}
 
 	void BoardState::printBoard() {
@@ -817,7 +1374,7 @@ namespace Chess {
 	}
 
 	void BoardState::updateAllPossibleMoves() {
-		allPossibleMoves = generateAllPossibleMoves();
+		generateLegalMoves(allPossibleMoves);
 	}
 
 }
\ No newline at end of file
@@ -0,0 +1,35 @@
+#ifndef EVALUATION_H
+#define EVALUATION_H
+
+#include "Pawns.h"
+
+namespace Chess {
+
+	// material value of every piece type in centipawns
+	// same order as the Piece enum, the king is never traded
+	const int pieceValues[6] = {
+		320, // KNIGHT
+		330, // BISHOP
+		500, // ROOK
+		900, // QUEEN
+		0,   // KING
+		100  // PAWN
+	};
+
+	// https://www.chessprogramming.org/Evaluation
+	// static score of the position in centipawns
+	// from the point of view of the side to move
+	// material and piece square tables, read from the sums BoardState keeps up to date
+	// and the pawn structure from the pawn table of the searching thread
+	// the neural network instead once its weights are loaded
+	int evaluate(BoardState& board, PawnTable& pawns);
+
+	// https://www.chessprogramming.org/Static_Exchange_Evaluation
+	// material won or lost by the side to move when the move starts an exchange
+	// of captures on its target square, both sides always recapture with
+	// the least valuable attacker and may stop when going on would lose
+	// pins are not considered
+	int staticExchange(BoardState& board, Move move);
+}
+
+#endif // EVALUATION_H
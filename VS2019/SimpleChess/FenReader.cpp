@@ -0,0 +1,100 @@
+#include "FenReader.h"
+
+namespace Chess {
+
+	FenReader::FenReader(size_t bufferSize) : buffer(std::max<size_t>(bufferSize, 256) + 1) {
+		file = nullptr;
+		begin = end = 0;
+		endOfFile = true;
+		lines = invalidLines = 0;
+	}
+
+	FenReader::~FenReader() {
+		close();
+	}
+
+	bool FenReader::open(const string& path) {
+		close();
+
+		file = std::fopen(path.c_str(), "rb");
+		begin = end = 0;
+		endOfFile = file == nullptr;
+		lines = invalidLines = 0;
+
+		return file != nullptr;
+	}
+
+	void FenReader::close() {
+		if (file)
+			std::fclose(file);
+		file = nullptr;
+		endOfFile = true;
+	}
+
+	void FenReader::fill() {
+		std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+		end -= begin;
+		begin = 0;
+
+		size_t capacity = buffer.size() - 1;
+		size_t read = std::fread(buffer.data() + end, 1, capacity - end, file);
+		end += read;
+
+		if (read == 0)
+			endOfFile = true;
+	}
+
+	void FenReader::skipLine() {
+		while (!endOfFile) {
+			begin = end = 0;
+			fill();
+
+			char* newline = (char*)std::memchr(buffer.data(), '\n', end);
+			if (newline) {
+				begin = newline - buffer.data() + 1;
+				return;
+			}
+		}
+
+		begin = end;
+	}
+
+	bool FenReader::next(BoardState& board) {
+		while (true) {
+			char* line = buffer.data() + begin;
+			char* lineEnd = (char*)std::memchr(line, '\n', end - begin);
+
+			if (!lineEnd && !endOfFile) {
+				// a line filling the whole buffer is far too long for a position
+				if (begin == 0 && end == buffer.size() - 1) {
+					skipLine();
+					lines++;
+					invalidLines++;
+				}
+				else
+					fill();
+				continue;
+			}
+
+			// last line without end of line
+			if (!lineEnd) {
+				if (begin == end)
+					return false;
+				lineEnd = buffer.data() + end;
+			}
+
+			begin = std::min<size_t>(lineEnd - buffer.data() + 1, end);
+			*lineEnd = '\0';
+
+			if (*line == '\0' || *line == '\r')
+				continue;
+
+			lines++;
+
+			if (board.loadFen(line))
+				return true;
+
+			invalidLines++;
+		}
+	}
+}
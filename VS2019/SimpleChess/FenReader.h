@@ -0,0 +1,45 @@
+#ifndef FEN_READER_H
+#define FEN_READER_H
+
+#include "BoardState.h"
+#include <cstdio>
+
+namespace Chess {
+
+	// reads one position per line from a fen or epd file
+	// the file is read in large blocks and every line is parsed straight from the block
+	// so nothing is allocated per position, the buffer is allocated once
+	class FenReader {
+	private:
+		std::FILE* file;
+		// one extra byte to terminate a last line without end of line
+		std::vector<char> buffer;
+		// unread part of the buffer
+		size_t begin;
+		size_t end;
+		bool endOfFile;
+
+		uint64_t lines;
+		uint64_t invalidLines;
+
+	private:
+		// moves the unread part to the front and reads the next block after it
+		void fill();
+		// drops the rest of a line that does not fit into the buffer
+		void skipLine();
+
+	public:
+		FenReader(size_t bufferSize = 1 << 20);
+		~FenReader();
+		bool open(const string& path);
+		void close();
+		// loads the next valid position into the board
+		// empty lines are skipped, invalid ones are skipped and counted
+		// returns false at the end of the file
+		bool next(BoardState& board);
+		uint64_t getLines() { return lines; }
+		uint64_t getInvalidLines() { return invalidLines; }
+	};
+}
+
+#endif // FEN_READER_H
@@ -0,0 +1,67 @@
+#ifndef MOVE_PICKER_H
+#define MOVE_PICKER_H
+
+#include "Evaluation.h"
+
+namespace Chess {
+
+	// https://www.chessprogramming.org/Move_Generation#Staged_Move_Generation
+	// hands out the legal moves of a node one at a time, best ordered first
+	// every stage is generated only once the stages before it are used up
+	// so a node that cuts off on the hash move or a capture never generates its quiet moves
+	class MovePicker {
+	private:
+		enum Stage : int {
+			HASHSTAGE,
+			GENCAPTURESSTAGE,
+			CAPTURESSTAGE,
+			KILLERSSTAGE,
+			GENQUIETSSTAGE,
+			QUIETSSTAGE,
+			UNDERPROMOTIONSSTAGE,
+			DONESTAGE
+		};
+
+		BoardState& board;
+		int stage;
+
+		CompactMove hashMove;
+		CompactMove killers[2];
+		// history of the side to move, indexed by from and to (0-63 indexes)
+		const int (*history)[64];
+		// captures only, underpromotions are left out
+		bool capturesOnly;
+
+		// moves of the current stage, scores has the same index
+		MoveList moves;
+		int scores[256];
+		int index;
+
+		// underpromotions are almost never better than the queen, they come last
+		MoveList underpromotions;
+
+	private:
+		// https://www.chessprogramming.org/MVV-LVA
+		// most valuable victim first, among the same victims the least valuable attacker
+		// queen promotions count as winning the difference to a pawn
+		void scoreCaptures();
+		void scoreQuiets();
+		// swaps the best scored move of the rest of the list to index and returns it
+		Move pickBest();
+		// hash and killer moves come from tables, they may not be legal in this position
+		bool isLegal(Move move);
+		// already handed out by the hash or killer stage
+		bool isSearched(CompactMove move);
+
+	public:
+		// every legal move, the hash move first, then captures, killers and quiet moves
+		MovePicker(BoardState& board, CompactMove hashMove, const CompactMove* killers, const int (*history)[64]);
+		// quiescence search, captures and queen promotions only
+		// in check every evasion, there is no hash move and no killers
+		MovePicker(BoardState& board, bool inCheck, const int (*history)[64]);
+		// false when there are no moves left
+		bool next(Move& move);
+	};
+}
+
+#endif // MOVE_PICKER_H
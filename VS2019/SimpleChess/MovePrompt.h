@@ -23,12 +23,15 @@ namespace Chess {
 		IndexPair parseMove(string move);
 		string readPromotionMove();
 		Piece parsePromotionMove(string move);
+		// long algebraic notation used by perft output, e2e4 or e7e8q
+		string moveToString(Move move);
 		bool askForDraw();
 		
 		IndexPair getMove(Color playerColor) { return parseMove(readMove(playerColor)); }
 		Piece getPromotionMove() { return parsePromotionMove(readPromotionMove()); }
 		
 		void playerWonMsg(Color player);
+		void computerMoveMsg(Move move) { cout << "Computer plays " << moveToString(move) << endl; }
 
 		void drawByRepetitionMsg() { cout << "Draw by threefold repetition" << endl; }
 		void drawBy50MovesMsg() { cout << "Draw by 50 moves rule" << endl; }
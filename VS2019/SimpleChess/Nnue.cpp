@@ -0,0 +1,201 @@
+#include "Nnue.h"
+#include <fstream>
+
+namespace Chess {
+
+	Network network;
+
+	Network::Network() {
+		outputBias = 0;
+		loaded = false;
+		generation = 0;
+	}
+
+	template<typename T>
+	static bool readArray(std::istream& file, std::vector<T>& values, size_t count) {
+		// x86 and x64 are little endian like the file, the bytes are read as they are
+		values.resize(count);
+		file.read(reinterpret_cast<char*>(values.data()), count * sizeof(T));
+		return (bool)file;
+	}
+
+	bool Network::load(const std::string& path) {
+		std::ifstream file(path, std::ios::binary);
+		char magic[4];
+		uint32_t header[4];
+
+		if (!file.read(magic, 4) || std::memcmp(magic, "SCNN", 4) != 0)
+			return false;
+		if (!file.read(reinterpret_cast<char*>(header), sizeof(header)))
+			return false;
+		if (header[0] != 1 || header[1] != NNUE_L1 || header[2] != NNUE_L2 || header[3] != NNUE_L3)
+			return false;
+
+		Network next;
+		std::vector<int32_t> bias;
+
+		bool ok = readArray(file, next.featureBiases, NNUE_L1) &&
+			readArray(file, next.featureWeights, (size_t)NNUE_INPUTS * NNUE_L1) &&
+			readArray(file, next.biases2, NNUE_L2) &&
+			readArray(file, next.weights2, NNUE_L2 * 2 * NNUE_L1) &&
+			readArray(file, next.biases3, NNUE_L3) &&
+			readArray(file, next.weights3, NNUE_L3 * NNUE_L2) &&
+			readArray(file, bias, 1) &&
+			readArray(file, next.outputWeights, NNUE_L3);
+
+		if (!ok)
+			return false;
+
+		next.outputBias = bias[0];
+		next.loaded = true;
+		next.generation = generation + 1;
+		*this = std::move(next);
+
+		return true;
+	}
+
+	void Network::refresh(int16_t* values) const {
+		std::memcpy(values, featureBiases.data(), NNUE_L1 * sizeof(int16_t));
+	}
+
+	void Network::addFeature(int16_t* values, int feature) const {
+		update(values, values, &feature, 1, nullptr, 0);
+	}
+
+	void Network::update(const int16_t* input, int16_t* output, const int* added, int addedCount, const int* removed, int removedCount) const {
+		const int16_t* weights = featureWeights.data();
+
+#if defined(NNUE_AVX2)
+		for (int j = 0; j < NNUE_L1; j += 16) {
+			__m256i v = _mm256_loadu_si256((const __m256i*)(input + j));
+			for (int i = 0; i < addedCount; i++)
+				v = _mm256_add_epi16(v, _mm256_loadu_si256((const __m256i*)(weights + (size_t)added[i] * NNUE_L1 + j)));
+			for (int i = 0; i < removedCount; i++)
+				v = _mm256_sub_epi16(v, _mm256_loadu_si256((const __m256i*)(weights + (size_t)removed[i] * NNUE_L1 + j)));
+			_mm256_storeu_si256((__m256i*)(output + j), v);
+		}
+#elif defined(NNUE_SSSE3)
+		for (int j = 0; j < NNUE_L1; j += 8) {
+			__m128i v = _mm_loadu_si128((const __m128i*)(input + j));
+			for (int i = 0; i < addedCount; i++)
+				v = _mm_add_epi16(v, _mm_loadu_si128((const __m128i*)(weights + (size_t)added[i] * NNUE_L1 + j)));
+			for (int i = 0; i < removedCount; i++)
+				v = _mm_sub_epi16(v, _mm_loadu_si128((const __m128i*)(weights + (size_t)removed[i] * NNUE_L1 + j)));
+			_mm_storeu_si128((__m128i*)(output + j), v);
+		}
+#else
+		for (int j = 0; j < NNUE_L1; j++) {
+			int16_t v = input[j];
+			for (int i = 0; i < addedCount; i++)
+				v += weights[(size_t)added[i] * NNUE_L1 + j];
+			for (int i = 0; i < removedCount; i++)
+				v -= weights[(size_t)removed[i] * NNUE_L1 + j];
+			output[j] = v;
+		}
+#endif
+	}
+
+#if defined(NNUE_AVX2)
+	static int horizontalSum(__m256i v) {
+		__m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+		s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+		s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+		return _mm_cvtsi128_si32(s);
+	}
+#elif defined(NNUE_SSSE3)
+	static int horizontalSum(__m128i s) {
+		s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+		s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+		return _mm_cvtsi128_si32(s);
+	}
+#endif
+
+	// accumulator values clipped to 0-127, the input of the dense layers
+	static void clipAccumulator(const int16_t* values, uint8_t* output) {
+#if defined(NNUE_AVX2)
+		const __m256i zero = _mm256_setzero_si256();
+		for (int j = 0; j < NNUE_L1; j += 32) {
+			__m256i a = _mm256_loadu_si256((const __m256i*)(values + j));
+			__m256i b = _mm256_loadu_si256((const __m256i*)(values + j + 16));
+			// packing works on 128 bit lanes, the permute puts the quarters back in order
+			__m256i packed = _mm256_max_epi8(_mm256_packs_epi16(a, b), zero);
+			_mm256_storeu_si256((__m256i*)(output + j), _mm256_permute4x64_epi64(packed, 0xD8));
+		}
+#elif defined(NNUE_SSSE3)
+		const __m128i zero = _mm_setzero_si128();
+		for (int j = 0; j < NNUE_L1; j += 16) {
+			__m128i a = _mm_max_epi16(_mm_loadu_si128((const __m128i*)(values + j)), zero);
+			__m128i b = _mm_max_epi16(_mm_loadu_si128((const __m128i*)(values + j + 8)), zero);
+			_mm_storeu_si128((__m128i*)(output + j), _mm_packs_epi16(a, b));
+		}
+#else
+		for (int j = 0; j < NNUE_L1; j++)
+			output[j] = (uint8_t)std::min(std::max((int)values[j], 0), 127);
+#endif
+	}
+
+	// output[i] = biases[i] + sum of weights[i][j] * input[j]
+	// inputs are at most 127 so the 16 bit pair sums of maddubs can not saturate
+	static void affine(const uint8_t* input, int inputs, const int8_t* weights, const int32_t* biases, int outputs, int32_t* output) {
+#if defined(NNUE_AVX2)
+		const __m256i ones = _mm256_set1_epi16(1);
+		for (int i = 0; i < outputs; i++) {
+			const int8_t* row = weights + i * inputs;
+			__m256i sum = _mm256_setzero_si256();
+			for (int j = 0; j < inputs; j += 32) {
+				__m256i product = _mm256_maddubs_epi16(_mm256_loadu_si256((const __m256i*)(input + j)), _mm256_loadu_si256((const __m256i*)(row + j)));
+				sum = _mm256_add_epi32(sum, _mm256_madd_epi16(product, ones));
+			}
+			output[i] = biases[i] + horizontalSum(sum);
+		}
+#elif defined(NNUE_SSSE3)
+		const __m128i ones = _mm_set1_epi16(1);
+		for (int i = 0; i < outputs; i++) {
+			const int8_t* row = weights + i * inputs;
+			__m128i sum = _mm_setzero_si128();
+			for (int j = 0; j < inputs; j += 16) {
+				__m128i product = _mm_maddubs_epi16(_mm_loadu_si128((const __m128i*)(input + j)), _mm_loadu_si128((const __m128i*)(row + j)));
+				sum = _mm_add_epi32(sum, _mm_madd_epi16(product, ones));
+			}
+			output[i] = biases[i] + horizontalSum(sum);
+		}
+#else
+		for (int i = 0; i < outputs; i++) {
+			const int8_t* row = weights + i * inputs;
+			int32_t sum = biases[i];
+			for (int j = 0; j < inputs; j++)
+				sum += input[j] * row[j];
+			output[i] = sum;
+		}
+#endif
+	}
+
+	static void clippedRelu(const int32_t* input, int count, uint8_t* output) {
+		for (int i = 0; i < count; i++)
+			output[i] = (uint8_t)std::min(std::max(input[i] >> NNUE_WEIGHTSHIFT, 0), 127);
+	}
+
+	int Network::evaluate(const Accumulator& accumulator, Color sideToMove) const {
+		uint8_t input[2 * NNUE_L1];
+		int32_t sums2[NNUE_L2];
+		uint8_t hidden2[NNUE_L2];
+		int32_t sums3[NNUE_L3];
+		uint8_t hidden3[NNUE_L3];
+
+		// side to move first, the network knows whose turn it is only from the order
+		clipAccumulator(accumulator.values[sideToMove], input);
+		clipAccumulator(accumulator.values[sideToMove == WHITE ? BLACK : WHITE], input + NNUE_L1);
+
+		affine(input, 2 * NNUE_L1, weights2.data(), biases2.data(), NNUE_L2, sums2);
+		clippedRelu(sums2, NNUE_L2, hidden2);
+
+		affine(hidden2, NNUE_L2, weights3.data(), biases3.data(), NNUE_L3, sums3);
+		clippedRelu(sums3, NNUE_L3, hidden3);
+
+		int32_t output = outputBias;
+		for (int i = 0; i < NNUE_L3; i++)
+			output += hidden3[i] * outputWeights[i];
+
+		return output / NNUE_OUTPUTSCALE;
+	}
+}
@@ -0,0 +1,97 @@
+#ifndef PERFT_H
+#define PERFT_H
+
+#include "BoardState.h"
+#include <atomic>
+#include <memory>
+#include <thread>
+
+namespace Chess {
+
+	// https://www.chessprogramming.org/Perft
+	// counts the leaf nodes of the legal move tree up to given depth
+	// legal moves on the last ply are only counted, not played (bulk counting)
+	uint64_t perft(BoardState& board, int depth);
+
+	// https://www.chessprogramming.org/Perft#Hashing
+	// node counts of subtrees already counted, a transposition is counted only once
+	// the zobrist key covers castling rights and the enpassant square, so it tells positions apart
+	// shared by the workers without locks like the transposition table
+	class PerftTable {
+	private:
+		// check is the key mixed with the depth, xored with the node count
+		// a slot torn by two writers fails the check
+		struct Slot {
+			std::atomic<uint64_t> check;
+			std::atomic<uint64_t> nodes;
+		};
+
+		std::unique_ptr<Slot[]> slots;
+		size_t mask;
+
+	private:
+		// the same position at another depth has another count
+		static uint64_t mix(BoardStateHash key, int depth) { return key ^ (uint64_t)depth * 0x9E3779B97F4A7C15ULL; }
+
+	public:
+		// rounds down to a power of two slots
+		explicit PerftTable(size_t megabytes);
+		bool probe(BoardStateHash key, int depth, uint64_t& nodes);
+		// always replaces, deep counts are rare and cheap to lose
+		void store(BoardStateHash key, int depth, uint64_t nodes);
+	};
+
+	// perft that looks up and stores every subtree of two or more plies in the table
+	uint64_t perft(BoardState& board, int depth, PerftTable& table);
+
+	// leaf nodes below every legal root move and how the work was shared
+	struct PerftResult {
+		MoveList moves;
+		std::vector<uint64_t> moveNodes; // same index as moves
+		uint64_t nodes = 0;
+		int64_t time = 0; // milliseconds
+		int threads = 1;
+		// cpu time the workers spent counting out of threads * time, in percent
+		// lower when the last subtrees leave workers waiting or threads share a core
+		int efficiency = 100;
+	};
+
+	// https://www.chessprogramming.org/Parallel_Search#Parallel_Perft
+	// the tree is split into subtrees which the workers take one by one
+	// every worker counts on its own copy of the board, nothing is shared while counting
+	// with few root moves the tree is split deeper, so there is enough work for every worker
+	class Perft {
+	private:
+		// subtree below a position, rootIndex is the root move leading to it
+		struct Task {
+			Position position;
+			int rootIndex;
+			uint64_t nodes;
+		};
+
+		// counters of one worker, merged once all workers have finished
+		struct WorkerStats {
+			uint64_t nodes = 0;
+			int64_t cpuTime = 0; // microseconds
+		};
+
+		std::vector<Task> tasks;
+		std::atomic<size_t> nextTask;
+
+		// no caching without a table
+		std::unique_ptr<PerftTable> table;
+
+	private:
+		// replaces every task by one task for every legal move of its position
+		void split(BoardState& board);
+		void worker(int depth, WorkerStats& stats);
+
+	public:
+		// hashMegabytes 0 counts every subtree
+		explicit Perft(size_t hashMegabytes = 0);
+		// the board is left as it was
+		void run(BoardState& board, int depth, int threads, PerftResult& result);
+	};
+}
+
+#endif // PERFT_H
@@ -0,0 +1,61 @@
+#ifndef PGN_VALIDATOR_H
+#define PGN_VALIDATOR_H
+
+#include "BoardState.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+namespace Chess {
+
+	// games of a pgn file replayed by PgnValidator
+	struct PgnStats {
+		uint64_t games = 0;
+		uint64_t moves = 0;
+		// games with an illegal, ambiguous or unreadable move or fen
+		uint64_t illegal = 0;
+		// final GameStatus of the legal games, indexed by GameStatus
+		uint64_t status[NOTOVER + 1] = {};
+
+		void add(const PgnStats& other);
+	};
+
+	// https://www.chessprogramming.org/Portable_Game_Notation
+	// streams a pgn archive, splits it into games and replays every game
+	// through BoardState on a pool of worker threads
+	// the reading thread only splits the text, parsing and replaying is done by the workers
+	class PgnValidator {
+	private:
+		// games handed to a worker at once, one lock for the whole batch
+		struct Batch {
+			uint64_t firstGame;
+			std::vector<string> games;
+		};
+
+		std::deque<Batch> queue;
+		std::mutex queueMutex;
+		std::condition_variable queueNotEmpty;
+		std::condition_variable queueNotFull;
+		bool endOfInput;
+
+		// keeps the reports of illegal games on whole lines
+		std::mutex outputMutex;
+
+	private:
+		void worker(PgnStats& stats);
+		// replays one game on the board, reports the first illegal move
+		void replay(BoardState& board, const string& game, uint64_t gameNumber, PgnStats& stats);
+		void report(uint64_t gameNumber, int ply, const string& message);
+		void push(Batch& batch);
+
+	public:
+		PgnValidator();
+		// returns false if the file can not be opened
+		bool run(const string& path, int threads, PgnStats& stats);
+	};
+}
+
+#endif // PGN_VALIDATOR_H
@@ -0,0 +1,345 @@
+#include "Search.h"
+
+namespace Chess {
+
+	Search::Search(BoardState& board, TranspositionTable& table) : board(board), table(table) {
+		nodes = 0;
+		stopped = false;
+	}
+
+	int Search::scoreToTable(int score, int ply) {
+		if (score > MATEBOUND)
+			return score + ply;
+		if (score < -MATEBOUND)
+			return score - ply;
+		return score;
+	}
+
+	int Search::scoreFromTable(int score, int ply) {
+		if (score > MATEBOUND)
+			return score - ply;
+		if (score < -MATEBOUND)
+			return score + ply;
+		return score;
+	}
+
+	int64_t Search::elapsed() {
+		return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+	}
+
+	uint64_t Search::totalNodes() {
+		uint64_t total = nodes.load(std::memory_order_relaxed);
+		for (auto& helper : helpers)
+			total += helper->nodes.load(std::memory_order_relaxed);
+		return total;
+	}
+
+	void Search::checkLimits() {
+		uint64_t searched = nodes.load(std::memory_order_relaxed);
+
+		// reading the clock and the helper counters is slow compared to a node, do it every 2048 nodes
+		if ((searched & 2047) != 0)
+			return;
+
+		if (limits.nodes && totalNodes() >= limits.nodes)
+			stopped = true;
+
+		if (limits.movetime && elapsed() >= limits.movetime)
+			stopped = true;
+	}
+
+	bool Search::prepare(const SearchLimits& searchLimits, SearchResult& result) {
+		limits = searchLimits;
+		startTime = std::chrono::steady_clock::now();
+		nodes = 0;
+		previousPv.clear();
+		std::memset(killers, 0, sizeof(killers));
+		std::memset(history, 0, sizeof(history));
+
+		MoveList rootMoves;
+		board.generateLegalMoves(rootMoves);
+
+		// nothing to search, still return a playable move if there is one
+		if (rootMoves.empty())
+			return false;
+		result.bestMove = rootMoves[0];
+		result.pv.push(rootMoves[0]);
+
+		return true;
+	}
+
+	void Search::iterate(int firstDepth, SearchResult& result) {
+		for (int depth = firstDepth; depth <= limits.depth && depth < MAXPLY; depth++) {
+			int score = negamax(depth, 0, -INFINITESCORE, INFINITESCORE);
+
+			// results of an interrupted iteration are not trusted
+			if (stopped && previousPv.size() > 0)
+				break;
+
+			result.score = score;
+			result.depth = depth;
+			result.pv.clear();
+			for (int i = 0; i < pvLength[0]; i++)
+				result.pv.push(pvTable[0][i]);
+			result.bestMove = result.pv[0];
+			previousPv = result.pv;
+
+			result.nodes = totalNodes();
+			result.time = elapsed();
+
+			if (limits.printInfo)
+				printIteration(result);
+
+			// no point searching deeper once a forced mate is found
+			if (stopped || score > MATEBOUND || score < -MATEBOUND)
+				break;
+		}
+	}
+
+	SearchResult Search::think(const SearchLimits& searchLimits) {
+		SearchResult result;
+
+		helpers.clear();
+		helperBoards.clear();
+		table.newSearch();
+
+		if (!prepare(searchLimits, result))
+			return result;
+
+		// https://www.chessprogramming.org/Lazy_SMP
+		// helpers search their own copy of the board without a node or time limit
+		// and are stopped when the main search finishes
+		// every other helper starts one ply deeper so the threads do not stay in step
+		SearchLimits helperLimits;
+		helperLimits.depth = limits.depth;
+
+		std::vector<SearchResult> helperResults(std::max(limits.threads, 1) - 1);
+		std::vector<std::thread> threads;
+
+		for (size_t i = 0; i < helperResults.size(); i++) {
+			helperBoards.emplace_back(new BoardState(board));
+			helpers.emplace_back(new Search(*helperBoards.back(), table));
+			helpers.back()->prepare(helperLimits, helperResults[i]);
+		}
+
+		for (size_t i = 0; i < helpers.size(); i++)
+			threads.emplace_back(&Search::iterate, helpers[i].get(), 1 + (int)(i & 1), std::ref(helperResults[i]));
+
+		iterate(1, result);
+
+		for (auto& helper : helpers)
+			helper->stop();
+		for (auto& thread : threads)
+			thread.join();
+
+		result.nodes = totalNodes();
+		result.time = elapsed();
+
+		// cleared only here so a stop sent right after the search started is not lost
+		stopped = false;
+
+		return result;
+	}
+
+	int Search::negamax(int depth, int ply, int alpha, int beta) {
+		if (depth <= 0)
+			return quiescence(ply, alpha, beta);
+
+		pvLength[ply] = 0;
+
+		// only this thread writes the counter, a plain increment is enough
+		nodes.store(nodes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		checkLimits();
+
+		// the first iteration has to finish so there is always a move to play
+		if (stopped && ply > 0 && previousPv.size() > 0)
+			return 0;
+
+		// https://www.chessprogramming.org/Repetitions#Repetitions_in_Search
+		// one repetition is enough, the side that could avoid it will not play better the second time
+		if (ply > 0 && (board.getFiftyMoves() >= 100 || board.isRepetition()))
+			return 0;
+
+		if (ply >= MAXPLY - 1)
+			return evaluate(board, pawns);
+
+		// https://www.chessprogramming.org/Transposition_Table#How_to_use
+		// a deep enough entry can end the search of this node
+		// the root is always searched to get a full principal variation
+		TTEntry entry;
+		bool tableHit = table.probe(board.getHash(), entry);
+
+		if (tableHit && ply > 0 && entry.depth >= depth) {
+			int tableScore = scoreFromTable(entry.score, ply);
+
+			if (entry.bound() == BOUNDEXACT ||
+				(entry.bound() == BOUNDLOWER && tableScore >= beta) ||
+				(entry.bound() == BOUNDUPPER && tableScore <= alpha))
+				return tableScore;
+		}
+
+		// best move stored for this position goes first
+		// otherwise the move of the previous iteration's principal variation
+		CompactMove firstMove = tableHit ? entry.move : ply < previousPv.size() ? CompactMove(previousPv[ply]) : CompactMove();
+		MovePicker picker(board, firstMove, killers[ply], history[board.getPlayerColor()]);
+
+		int originalAlpha = alpha;
+		int bestScore = -INFINITESCORE;
+		Move bestMove = Move();
+		int searched = 0;
+		Move move;
+
+		// moves come one at a time, after a cutoff the rest is never generated or sorted
+		while (picker.next(move)) {
+			if (searched++ == 0)
+				bestMove = move;
+
+			board.playMove(move);
+			int score = -negamax(depth - 1, ply + 1, -beta, -alpha);
+			board.unmakeMove();
+
+			if (stopped && previousPv.size() > 0)
+				return 0;
+
+			if (score > bestScore) {
+				bestScore = score;
+				bestMove = move;
+
+				if (score > alpha) {
+					alpha = score;
+
+					// new best line is this move followed by the line of the child
+					pvTable[ply][0] = move;
+					for (int i = 0; i < pvLength[ply + 1]; i++)
+						pvTable[ply][i + 1] = pvTable[ply + 1][i];
+					pvLength[ply] = pvLength[ply + 1] + 1;
+
+					// https://www.chessprogramming.org/Beta-Cutoff
+					if (alpha >= beta) {
+						if (!(move.move.byteData.type & (CAPTURE | PROMOTE)))
+							updateQuietStats(move, ply, depth);
+						break;
+					}
+				}
+			}
+		}
+
+		// checkmate or stalemate
+		// prefer the shortest mate, delay being mated as long as possible
+		if (searched == 0)
+			return board.kingInCheck() ? -MATESCORE + ply : 0;
+
+		int bound = bestScore >= beta ? BOUNDLOWER : bestScore > originalAlpha ? BOUNDEXACT : BOUNDUPPER;
+		table.store(board.getHash(), CompactMove(bestMove), scoreToTable(bestScore, ply), depth, bound);
+
+		return bestScore;
+	}
+
+	int Search::quiescence(int ply, int alpha, int beta) {
+		pvLength[ply] = 0;
+
+		nodes.store(nodes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		checkLimits();
+
+		if (stopped && previousPv.size() > 0)
+			return 0;
+
+		if (ply >= MAXPLY - 1)
+			return evaluate(board, pawns);
+
+		// in check every evasion is searched, there is no quiet alternative to stand on
+		bool inCheck = board.kingInCheck();
+		int bestScore = -INFINITESCORE;
+
+		// https://www.chessprogramming.org/Quiescence_Search#Standing_Pat
+		// the side to move does not have to capture, the static score is a lower bound
+		if (!inCheck) {
+			bestScore = evaluate(board, pawns);
+
+			if (bestScore >= beta)
+				return bestScore;
+			alpha = std::max(alpha, bestScore);
+		}
+
+		MovePicker picker(board, inCheck, history[board.getPlayerColor()]);
+		int searched = 0;
+		Move move;
+
+		while (picker.next(move)) {
+			// captures losing material in the exchange can not raise the score above standing pat
+			if (!inCheck && staticExchange(board, move) < 0)
+				continue;
+
+			searched++;
+			board.playMove(move);
+			int score = -quiescence(ply + 1, -beta, -alpha);
+			board.unmakeMove();
+
+			if (stopped && previousPv.size() > 0)
+				return 0;
+
+			if (score > bestScore) {
+				bestScore = score;
+
+				if (score > alpha) {
+					alpha = score;
+
+					pvTable[ply][0] = move;
+					for (int j = 0; j < pvLength[ply + 1]; j++)
+						pvTable[ply][j + 1] = pvTable[ply + 1][j];
+					pvLength[ply] = pvLength[ply + 1] + 1;
+
+					if (alpha >= beta)
+						break;
+				}
+			}
+		}
+
+		if (inCheck && searched == 0)
+			return -MATESCORE + ply;
+
+		return bestScore;
+	}
+
+	void Search::updateQuietStats(Move move, int ply, int depth) {
+		CompactMove compact(move);
+
+		if (compact != killers[ply][0]) {
+			killers[ply][1] = killers[ply][0];
+			killers[ply][0] = compact;
+		}
+
+		int& entry = history[board.getPlayerColor()][x88ToSquare(move.move.byteData.from)][x88ToSquare(move.move.byteData.to)];
+		entry += depth * depth;
+
+		// keep the scores below the killers, older cutoffs lose half of their weight
+		if (entry >= HISTORYMAX)
+			for (auto& side : history)
+				for (auto& from : side)
+					for (auto& to : from)
+						to /= 2;
+	}
+
+	void Search::printIteration(const SearchResult& result) {
+		MovePrompt prompt;
+		string line = "info depth " + std::to_string(result.depth) + " score ";
+
+		if (result.score > MATEBOUND)
+			line += "mate " + std::to_string((MATESCORE - result.score + 1) / 2);
+		else if (result.score < -MATEBOUND)
+			line += "mate " + std::to_string(-(MATESCORE + result.score) / 2);
+		else
+			line += "cp " + std::to_string(result.score);
+
+		line += " nodes " + std::to_string(result.nodes) + " time " + std::to_string(result.time);
+		line += " nps " + std::to_string(result.time > 0 ? result.nodes * 1000 / result.time : result.nodes);
+		line += " hashfull " + std::to_string(table.hashfull());
+
+		line += " pv";
+		for (int i = 0; i < result.pv.size(); i++)
+			line += " " + prompt.moveToString(result.pv[i]);
+
+		// one write per line, the output may be shared with another thread
+		cout << line + "\n" << std::flush;
+	}
+}
@@ -1,7 +1,7 @@
 #ifndef CHESS_H
 #define CHESS_H
 
-#include "BoardState.h"
+#include "Search.h"
 
 namespace Chess {
 
@@ -11,9 +11,19 @@ namespace Chess {
 		GameStatus previousState;
 		// used to read moves from standard input
 		MovePrompt prompt;
+		// side played by the computer, EMPTY when both players are human
+		int computerSide;
+		// how long the computer thinks about every move
+		SearchLimits computerLimits;
+		// kept for the whole game, positions of the next move were often searched already
+		TranspositionTable table;
+
+	private:
+		ValidMove computerMove();
 	
 	public:
 		SimpleChess();
+		SimpleChess(Color computer, SearchLimits limits);
 		void play();
 		bool gameOver(GameStatus status);
 
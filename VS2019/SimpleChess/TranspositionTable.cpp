@@ -0,0 +1,122 @@
+#include "TranspositionTable.h"
+
+namespace Chess {
+
+	static_assert(std::is_trivially_copyable<TTEntry>::value && sizeof(TTEntry) == sizeof(uint64_t), "TTEntry has to fit into one slot word");
+
+	TranspositionTable::TranspositionTable(size_t megabytes) {
+		generation = 0;
+		resize(megabytes);
+	}
+
+	uint64_t TranspositionTable::pack(const TTEntry& entry) {
+		uint64_t data;
+		std::memcpy(&data, &entry, sizeof(data));
+		return data;
+	}
+
+	TTEntry TranspositionTable::unpack(uint64_t data) {
+		TTEntry entry;
+		std::memcpy(&entry, &data, sizeof(entry));
+		return entry;
+	}
+
+	void TranspositionTable::resize(size_t megabytes) {
+		size_t count = std::max<size_t>(megabytes, 1) * 1024 * 1024 / sizeof(TTBucket);
+
+		// largest power of two that fits into the requested size
+		size_t buckets = 1;
+		while (buckets * 2 <= count)
+			buckets *= 2;
+
+		// extra space to align the first bucket to a cache line
+		memory.assign(buckets * sizeof(TTBucket) + 64, 0);
+		this->buckets = reinterpret_cast<TTBucket*>((reinterpret_cast<uintptr_t>(memory.data()) + 63) & ~uintptr_t(63));
+		bucketMask = buckets - 1;
+
+		for (size_t i = 0; i < buckets; i++)
+			new (&this->buckets[i]) TTBucket();
+
+		clear();
+	}
+
+	void TranspositionTable::clear() {
+		for (size_t i = 0; i <= bucketMask; i++)
+			for (auto& slot : buckets[i].slots)
+				slot.store(0, std::memory_order_relaxed);
+		generation = 0;
+	}
+
+	bool TranspositionTable::probe(BoardStateHash key, TTEntry& entry) {
+		TTBucket& bucket = buckets[key & bucketMask];
+		uint16_t check = (uint16_t)(key >> 48);
+
+		for (auto& slot : bucket.slots) {
+			TTEntry e = unpack(slot.load(std::memory_order_relaxed));
+
+			if (e.key == check && e.bound() != BOUNDNONE) {
+				entry = e;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void TranspositionTable::store(BoardStateHash key, CompactMove move, int score, int depth, int bound) {
+		TTBucket& bucket = buckets[key & bucketMask];
+		uint16_t check = (uint16_t)(key >> 48);
+		TTSlot* replace = &bucket.slots[0];
+		TTEntry old = unpack(replace->load(std::memory_order_relaxed));
+		bool sameKey = false;
+
+		// the same position is always overwritten
+		// otherwise replace the entry with the least value
+		// deep entries are worth more, entries of older searches lose 8 plies per search
+		int worst = INT32_MAX;
+
+		for (auto& slot : bucket.slots) {
+			TTEntry e = unpack(slot.load(std::memory_order_relaxed));
+
+			if (e.key == check && e.bound() != BOUNDNONE) {
+				replace = &slot;
+				old = e;
+				sameKey = true;
+				break;
+			}
+
+			int age = (generation - e.generation()) & 63;
+			int value = e.bound() == BOUNDNONE ? -1000 : e.depth - 8 * age;
+
+			if (value < worst) {
+				worst = value;
+				replace = &slot;
+				old = e;
+			}
+		}
+
+		TTEntry entry;
+		// keep the old best move if this search did not find one
+		entry.move = sameKey && move.data == 0 ? old.move : move;
+		entry.score = (int16_t)score;
+		entry.depth = (int8_t)depth;
+		entry.boundAndGeneration = (uint8_t)(bound | (generation << 2));
+		entry.key = check;
+
+		replace->store(pack(entry), std::memory_order_relaxed);
+	}
+
+	int TranspositionTable::hashfull() {
+		int used = 0;
+		size_t sample = std::min<size_t>(250, bucketMask + 1);
+
+		for (size_t i = 0; i < sample; i++)
+			for (auto& slot : buckets[i].slots) {
+				TTEntry e = unpack(slot.load(std::memory_order_relaxed));
+				if (e.bound() != BOUNDNONE && e.generation() == generation)
+					used++;
+			}
+
+		return (int)(used * 1000 / (sample * 8));
+	}
+}
@@ -1,10 +1,14 @@
 #ifndef TYPES_H
 #define TYPES_H
 
+#include <algorithm>
 #include <cinttypes>
+#include <cstring>
 #include <unordered_map>
+#include <vector>
 #include <regex> 
 #include <string>
+#include <random>
 #include <iostream>
 #include <ctype.h>
 
@@ -127,10 +131,76 @@ namespace Chess {
 	};
 
 	using Move = struct Move;
-	using Moves = std::unordered_map<int, Move>;
+
+	// move returned when no legal move matches, -1 is not a square
+	const Move NOMOVE = { { { -1, -1, 0, 0 } } };
+
+	// 0x88 index has the file in the low 3 bits and the rank in bits 4-6
+	// 64 square index packs the same rank and file into 6 bits
+	inline int x88ToSquare(int squareIndex) { return (squareIndex + (squareIndex & 7)) >> 1; }
+	inline int squareToX88(int square) { return square + (square & ~7); }
+
+	// special moves of CompactMove, the top 2 bits
+	enum CompactFlag : int {
+		COMPACTNORMAL = 0,
+		COMPACTPROMOTE = 1 << 14,
+		COMPACTENPASSANT = 2 << 14,
+		COMPACTCASTLE = 3 << 14,
+		COMPACTSPECIAL = 3 << 14
+	};
+
+	// https://www.chessprogramming.org/Encoding_Moves#From-To_Based
+	// 16 bit move for tables holding many moves (transposition table, killers, undo stack)
+	// from and to as 0-63 squares in the low 12 bits, promotion piece in bits 12-13
+	// capture and pawn flags are left out, the board still knows them
+	struct CompactMove {
+		// zero is no move, a1a1 is never played
+		// left uninitialized so that tables can copy entries as raw words, CompactMove() is no move
+		uint16_t data;
+
+		CompactMove() = default;
+		explicit CompactMove(Move m) {
+			int type = m.move.byteData.type;
+			data = (uint16_t)(x88ToSquare(m.move.byteData.from) | x88ToSquare(m.move.byteData.to) << 6);
+
+			if (type & PROMOTE)
+				data |= COMPACTPROMOTE | m.move.byteData.promote << 12;
+			else if (type & ENPASSANT)
+				data |= COMPACTENPASSANT;
+			else if (type & CASTLE)
+				data |= COMPACTCASTLE;
+		}
+
+		// 0x88 indexes
+		int from() const { return squareToX88(data & 63); }
+		int to() const { return squareToX88(data >> 6 & 63); }
+		int special() const { return data & COMPACTSPECIAL; }
+		// piece type, only for COMPACTPROMOTE
+		int promote() const { return data >> 12 & 3; }
+
+		bool operator == (CompactMove m) const { return data == m.data; }
+		bool operator != (CompactMove m) const { return data != m.data; }
+	};
+
+	// contiguous move list filled in place by the move generator
+	// lives on the stack, no allocation per generated move
+	// no position has more than 218 legal moves, pseudo legal ones stay below 256
+	struct MoveList {
+		Move moves[256];
+		int count = 0;
+
+		void push(Move move) { moves[count++] = move; }
+		void clear() { count = 0; }
+		int size() const { return count; }
+		bool empty() const { return count == 0; }
+
+		Move& operator [] (int index) { return moves[index]; }
+		const Move& operator [] (int index) const { return moves[index]; }
+		Move* begin() { return moves; }
+		Move* end() { return moves + count; }
+	};
 
 	using BoardStateHash = uint64_t;
-	using MoveHistory = std::unordered_map<BoardStateHash, int>;
 
 	// (fromFile, fromRank)
 	// to (toFile, toRank)
@@ -142,8 +212,20 @@ namespace Chess {
 	// second is the value of that move
 	using ValidMove = std::pair<bool, Move>;
 
-	// for square as a key return mask to update castling rights
-	using CastlingMask = std::unordered_map<int, int>;
+	// everything playMove overwrites that can not be recomputed from the move itself
+	// https://www.chessprogramming.org/Unmake_Move
+	struct UndoRecord {
+		CompactMove move;
+		int8_t piece; // type of the moved piece, PAWN for promotions
+		int8_t captured; // captured piece type, EMPTY if nothing was captured
+		int8_t castlingRights;
+		int8_t enpassantSquare;
+		int8_t whiteKingSquare;
+		int8_t blackKingSquare;
+		int fiftyMoves;
+	};
+
+	using UndoStack = std::vector<UndoRecord>;
 }
 
 #endif // TYPES_H
\ No newline at end of file
@@ -0,0 +1,193 @@
+#include "Uci.h"
+
+namespace Chess {
+
+	Uci::Uci() {
+		threads = 1;
+	}
+
+	Uci::~Uci() {
+		stopSearch();
+	}
+
+	void Uci::send(const string& line) {
+		cout << line + "\n" << std::flush;
+	}
+
+	void Uci::loop() {
+		string line;
+
+		while (std::getline(cin, line)) {
+			std::istringstream input(line);
+			string command;
+			input >> command;
+
+			if (command == "uci")
+				uci();
+			else if (command == "isready")
+				send("readyok");
+			else if (command == "ucinewgame") {
+				stopSearch();
+				table.clear();
+			}
+			else if (command == "position")
+				position(input);
+			else if (command == "go")
+				go(input);
+			else if (command == "stop")
+				stopSearch();
+			else if (command == "setoption")
+				setOption(input);
+			else if (command == "d") {
+				stopSearch();
+				board.printBoard();
+			}
+			else if (command == "quit") {
+				stopSearch();
+				return;
+			}
+		}
+
+		// end of input, let a scripted search finish on its own
+		if (searchThread.joinable())
+			searchThread.join();
+	}
+
+	void Uci::uci() {
+		send("id name SimpleChess");
+		send("id author moshi-git");
+		send("option name Hash type spin default 16 min 1 max 4096");
+		send("option name Threads type spin default 1 min 1 max 256");
+		send("option name EvalFile type string default <empty>");
+		send("uciok");
+	}
+
+	// position [startpos | fen <fen>] [moves <move>...]
+	void Uci::position(std::istringstream& input) {
+		string token, fen;
+
+		stopSearch();
+
+		input >> token;
+		if (token == "startpos") {
+			fen = STARTFEN;
+			input >> token;
+		}
+		else if (token == "fen") {
+			while (input >> token && token != "moves")
+				fen += token + " ";
+		}
+		else
+			return;
+
+		if (!board.loadFen(fen)) {
+			send("info string invalid fen " + fen);
+			return;
+		}
+
+		if (token != "moves")
+			return;
+
+		while (input >> token)
+			if (!playMove(token)) {
+				send("info string invalid move " + token);
+				return;
+			}
+	}
+
+	bool Uci::playMove(const string& text) {
+		if (text.size() < 4)
+			return false;
+
+		board.updateAllPossibleMoves();
+		ValidMove vmove = board.findMove(prompt.parseMove(text));
+
+		if (vmove.first && (vmove.second.move.byteData.type & PROMOTE))
+			vmove.second.move.byteData.promote = text.size() > 4 ? prompt.parsePromotionMove(text.substr(4)) : QUEEN;
+
+		return board.playNextMove(vmove, NOTOVER) != INVALIDMOVE;
+	}
+
+	// go [depth d] [nodes n] [movetime ms] [wtime ms] [btime ms] [winc ms] [binc ms] [movestogo n] [infinite]
+	void Uci::go(std::istringstream& input) {
+		SearchLimits limits;
+		int64_t time[2] = { 0, 0 };
+		int64_t increment[2] = { 0, 0 };
+		int64_t movesToGo = 0;
+		string token;
+
+		stopSearch();
+
+		while (input >> token) {
+			if (token == "depth")
+				input >> limits.depth;
+			else if (token == "nodes")
+				input >> limits.nodes;
+			else if (token == "movetime")
+				input >> limits.movetime;
+			else if (token == "wtime")
+				input >> time[WHITE];
+			else if (token == "btime")
+				input >> time[BLACK];
+			else if (token == "winc")
+				input >> increment[WHITE];
+			else if (token == "binc")
+				input >> increment[BLACK];
+			else if (token == "movestogo")
+				input >> movesToGo;
+		}
+
+		limits.depth = std::max(1, std::min(limits.depth, MAXPLY - 1));
+		limits.threads = threads;
+		limits.printInfo = true;
+
+		// https://www.chessprogramming.org/Time_Management
+		// equal share of the remaining time for the moves still to play plus most of the increment
+		// a margin is kept for the time the GUI needs to read the move
+		Color side = board.getPlayerColor();
+		if (!limits.movetime && time[side] > 0) {
+			int64_t share = time[side] / (movesToGo > 0 ? movesToGo : 30) + increment[side] * 3 / 4;
+			limits.movetime = std::max<int64_t>(1, std::min(share, time[side] - 50));
+		}
+
+		search.reset(new Search(board, table));
+		searchThread = std::thread([this, limits]() {
+			SearchResult result = search->think(limits);
+			send("bestmove " + prompt.moveToString(result.bestMove));
+		});
+	}
+
+	// setoption name <name> value <value>
+	void Uci::setOption(std::istringstream& input) {
+		string token, name, value;
+
+		input >> token;
+		while (input >> token && token != "value")
+			name += (name.empty() ? "" : " ") + token;
+		// the rest of the line, file names may contain spaces
+		std::getline(input >> std::ws, value);
+
+		stopSearch();
+
+		if (name == "Hash")
+			table.resize(std::max(1, atoi(value.c_str())));
+		else if (name == "Threads")
+			threads = std::max(1, atoi(value.c_str()));
+		else if (name == "EvalFile") {
+			if (network.load(value))
+				send("info string network loaded from " + value);
+			else
+				send("info string cannot load network from " + value);
+		}
+		else
+			send("info string unknown option " + name);
+	}
+
+	void Uci::stopSearch() {
+		if (!searchThread.joinable())
+			return;
+
+		search->stop();
+		searchThread.join();
+	}
+}
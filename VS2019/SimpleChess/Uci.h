@@ -0,0 +1,46 @@
+#ifndef UCI_H
+#define UCI_H
+
+#include "Search.h"
+#include <sstream>
+
+namespace Chess {
+
+	// https://www.chessprogramming.org/UCI
+	// text protocol used by chess GUIs and match runners, replaces MovePrompt
+	// commands are read on the calling thread while the search runs on its own thread
+	// so stop and isready are answered while the engine is thinking
+	class Uci {
+	private:
+		BoardState board;
+		// kept between searches, cleared by ucinewgame
+		TranspositionTable table;
+		MovePrompt prompt;
+		// value of the Threads option
+		int threads;
+
+		std::unique_ptr<Search> search;
+		std::thread searchThread;
+
+	private:
+		void uci();
+		void position(std::istringstream& input);
+		void go(std::istringstream& input);
+		void setOption(std::istringstream& input);
+		// stops the running search and waits until it printed its best move
+		void stopSearch();
+		// long algebraic move (e2e4, e7e8q) checked against the legal moves
+		bool playMove(const string& text);
+		// whole lines only so the output of both threads is never mixed
+		void send(const string& line);
+
+	public:
+		Uci();
+		~Uci();
+		// reads commands from standard input until quit or end of input
+		// at the end of input a running search is finished, quit stops it
+		void loop();
+	};
+}
+
+#endif // UCI_H
@@ -2,9 +2,14 @@
 #define BOARD_H
 
 #include "MovePrompt.h"
+#include "Position.h"
+#include "Psqt.h"
+#include "Nnue.h"
 
 namespace Chess {
 
+	const char* const STARTFEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
         class BoardState {
         private:
 			// tracks the position of the pieces on the board
@@ -17,21 +22,24 @@ namespace Chess {
 			// pawn, king, ...
 			int pieces[128];
 
-			// number of directions in which each piece except pawn can move around
-			// knight - 8 , can leap in all eight directions
-			// bishop - 4 , all four diagonal directions
-			// rook - 4 , up and down, left and right
-			// queen - 8 , bishop + rook
-			// king - 8 , all 8 squares around the king
-			int directions[5];
+			// https://www.chessprogramming.org/Bitboard_Board-Definition
+			// the same position as colors and pieces, one bitboard
+			// for every piece type of every color
+			Bitboard piecesBB[2][6];
+
+			// all pieces of one color
+			Bitboard colorsBB[2];
+
+			// all pieces on the board
+			Bitboard occupiedBB;
 
-			// offset for every piece except pawn, 6 of them
-			// in every direction, 8 directions
-			// around the square
-			int offset[5][8];
+			// sums of psqtMg and psqtEg over all pieces, white's point of view
+			// kept up to date with the pieces so the evaluation never scans the board
+			int mgScore;
+			int egScore;
 
-			// distinguish from sliding and nonsliding pieces
-			bool sliding[5];
+			// sum of phaseWeights over all pieces, MAXPHASE in the start position
+			int phase;
 
 			// who has castling rights
 			int castlingRights;
@@ -49,86 +57,216 @@ namespace Chess {
 			// increment and after 50 moves it is a draw by 50 moves rule
 			// every time there is a pawn moved or a capturing move reset
 			int fiftyMoves;
-		
-			// represents all possible pseudo legal moves in a current turn for a player
-			Moves allPossibleMoves;
-
-			// random starting values for zobrist hash
-			// 2 for both black and white
-			// 6 for each piece type (pawn, rook ...)
-			// 64 for every board postiion
-			BoardStateHash piecesHash[2][6][128];
 
-			// for every square enpassant random starting hash values
-			BoardStateHash enpassantHash[128];
-
-			// for player side random starting hash value
-			BoardStateHash playerColorHash;
+			// plies played before the position the board was set up from
+			// with the undo stack it gives the fullmove number of the fen
+			int startPly;
+		
+			// represents all legal moves in a current turn for a player
+			MoveList allPossibleMoves;
 
-			// keep move history as zobrist hash values
-			// used to detect threefold repetition
-			MoveHistory history;
 
 			// if threefold repetition is detected in this turn
 			bool threefoldRep;
 
-			// from index (64 values)
-			// to index (64 values)
-			// each entry represents hash value 
-			// hash = fromRank * 16 + fromFile (range for "to" from 0-15)
-			// same for toRank and toFile, min and max index 0-127 for both
-			int fromToHashTable[128][128];
-
 			int whiteKingSquare;
 
 			int blackKingSquare;
 
-			int pawnsSquares[2][8];
+			// zobrist hash of the current position
+			// updated incrementally by playMove, restored by unmakeMove
+			BoardStateHash hash;
+
+			// https://www.chessprogramming.org/Pawn_Hash_Table
+			// zobrist hash of the pawns only, the key of the pawn structure evaluation
+			BoardStateHash pawnHash;
+
+			// one record for every move played, popped by unmakeMove
+			UndoStack undoStack;
 
-			CastlingMask castling;
+			// https://www.chessprogramming.org/Repetitions
+			// hash of the position before every move of the undo stack, same index
+			// kept apart from the undo records so the repetition scan stays in a few cache lines
+			std::vector<BoardStateHash> keyStack;
+
+			// https://www.chessprogramming.org/NNUE#Incremental_Update
+			// network accumulator for every ply of the undo stack, filled only when evaluated
+			// an entry is valid for a perspective while its key matches the hash of that ply
+			// so unmakeMove has nothing to undo and siblings reuse the entries of their parents
+			std::vector<Accumulator> accumulators;
 
 		private:
 			void initColors();
 			void initPieces();
-			void initDirections();
-			void initOffset();
-			void initSliding();
-			void initZobristHash();
+			void initBitboardPosition();
 
 			char pieceToChar(Piece piece, Color color);
 
-			bool underAttackByKnight(int squareIndex, Color attackingSide);
-			bool underAttackByKing(int squareIndex, Color attackingSide);
-			bool underAttackByRookOrQueen(int squareIndex, Color attackingSide);
-			bool underAttackByBishopOrQueen(int squareIndex, Color attackingSide);
+			// add the move to the list, promotions are expanded
+			// into one move for every promotion piece
+			void pushMove(MoveList& moves, int from, int to, int type);
+			// one move from the square to every square in targets
+			void pushMoves(MoveList& moves, int from, Bitboard targets, int type);
+
+			// xors the pawn keys a move adds or takes away, the same call takes the move back
+			void updatePawnHash(const UndoRecord& undo, Color mover);
+
+			// hash of the position after the first ply moves of the undo stack
+			BoardStateHash hashAtPly(int ply) { return ply == (int)keyStack.size() ? hash : keyStack[ply]; }
+			// all features of one perspective of the current position
+			void refreshAccumulator(Accumulator& accumulator, Color perspective);
+			// next accumulator of one perspective from the move played at the ply
+			void applyMoveToAccumulator(int ply, Color perspective);
+
+			// which legal moves generateLegal produces
+			enum GenerationMode : int {
+				GENALL,
+				GENCAPTURES, // captures and promotions
+				GENQUIETS // everything else, castling included
+			};
+
+			void generateLegal(MoveList& moves, GenerationMode mode);
+
+			// rook from and to squares for a castling move
+			// kingTo is the square on which the king lands
+			IndexPair castlingRookMove(int kingTo);
+
+			// keep colors, pieces, the bitboards and the evaluation sums in sync
+			// hash is updated separately by playMove
+			void putPiece(Color color, int piece, int squareIndex) {
+				int square = x88ToSquare(squareIndex);
+				Bitboard b = squareBB(square);
+				colors[squareIndex] = color;
+				pieces[squareIndex] = piece;
+				piecesBB[color][piece] ^= b;
+				colorsBB[color] ^= b;
+				occupiedBB ^= b;
+				mgScore += psqtMg[color][piece][square];
+				egScore += psqtEg[color][piece][square];
+				phase += phaseWeights[piece];
+			}
+
+			void removePiece(int squareIndex) {
+				int square = x88ToSquare(squareIndex);
+				Bitboard b = squareBB(square);
+				int color = colors[squareIndex];
+				int piece = pieces[squareIndex];
+				piecesBB[color][piece] ^= b;
+				colorsBB[color] ^= b;
+				occupiedBB ^= b;
+				mgScore -= psqtMg[color][piece][square];
+				egScore -= psqtEg[color][piece][square];
+				phase -= phaseWeights[piece];
+				colors[squareIndex] = EMPTY;
+				pieces[squareIndex] = EMPTY;
+			}
+
+			void movePiece(int from, int to) {
+				int fromSquare = x88ToSquare(from);
+				int toSquare = x88ToSquare(to);
+				Bitboard b = squareBB(fromSquare) | squareBB(toSquare);
+				int color = colors[from];
+				int piece = pieces[from];
+				piecesBB[color][piece] ^= b;
+				colorsBB[color] ^= b;
+				occupiedBB ^= b;
+				mgScore += psqtMg[color][piece][toSquare] - psqtMg[color][piece][fromSquare];
+				egScore += psqtEg[color][piece][toSquare] - psqtEg[color][piece][fromSquare];
+				colors[to] = colors[from];
+				pieces[to] = pieces[from];
+				colors[from] = EMPTY;
+				pieces[from] = EMPTY;
+			}
 
 		public:
 			BoardState();
+			// start position, or the position of the fen if it is valid
+			explicit BoardState(const string& fen);
+			// set up the position of a fen string, the game history is cleared
+			// returns false and keeps the old position if the placement is invalid
+			bool loadFen(const char* fen);
+			bool loadFen(const string& fen) { return loadFen(fen.c_str()); }
+			string toFen();
+			explicit BoardState(const Position& position);
+			// the current position without the game history
+			void getPosition(Position& position);
+			// set up the position, the game history is cleared like by loadFen
+			void setPosition(const Position& position);
 			Color getPlayerColor() { return currentPlayer; }
+			// piece lists of the position, kept up to date by playMove and unmakeMove
+			// iterate with popLsb to visit only the squares holding that piece
+			Bitboard getPieces(Color color, Piece piece) { return piecesBB[color][piece]; }
+			Bitboard getPieces(Color color) { return colorsBB[color]; }
+			Bitboard getOccupied() { return occupiedBB; }
+			int getKingSquare(Color color) { return color == WHITE ? whiteKingSquare : blackKingSquare; }
+			// piece type on a 0x88 square, EMPTY if there is none
+			int getPiece(int squareIndex) { return pieces[squareIndex]; }
+			int getFiftyMoves() { return fiftyMoves; }
+			// material and piece square sums for the evaluation, white's point of view
+			int getMgScore() { return mgScore; }
+			int getEgScore() { return egScore; }
+			int getPhase() { return phase; }
+			// network accumulator of the current position, brought up to date
+			// from the nearest computed ply, needs a loaded network
+			const Accumulator& updateAccumulator();
 			int boardIndexToSquareIndex(int row, int column) { return row * 16 + column; }
 			bool validSquareIndex(int squareIndex) { return 0x88 & squareIndex ? false : true; }
 			int getRank(int squareIndex) { return squareIndex >> 4; } 
 			int getFile(int squareIndex) { return squareIndex & 0x7; }
 			// https://www.chessprogramming.org/Move_Generation
-			// Offset Move Generation
-			// https://www.chessprogramming.org/10x12_Board#OffsetMG
+			// bitboard move generation, targets of sliding pieces
+			// come from the magic bitboard lookup tables
 			// generate pseudo legal moves and check if the move
 			// that player wants to play is in the generated moves
-			// return all generated pseudo moves for a player in current turn
-			Moves generateAllPossibleMoves();
+			// fill the list with all generated pseudo moves for a player in current turn
+			void generateAllPossibleMoves(MoveList& moves);
+			// fill the list with legal moves only, no move has to be tested
+			// with testPseudoLegalMove afterwards
+			void generateLegalMoves(MoveList& moves);
+			// legal captures and promotions only, used by the quiescence search
+			void generateLegalCaptures(MoveList& moves);
+			// legal moves that are neither captures nor promotions
+			// with generateLegalCaptures the same moves as generateLegalMoves
+			void generateLegalQuiets(MoveList& moves);
+			// pieces of both colors attacking the square (0-63 index)
+			// with the given occupancy used for the sliding pieces
+			Bitboard attackersTo(int square, Bitboard occupied);
 			// https://www.chessprogramming.org/Zobrist_Hashing
+			// computes the hash from scratch, use getHash for the current position
 			BoardStateHash zobristHash();
+			BoardStateHash getHash() { return hash; }
+			BoardStateHash pawnZobristHash();
+			BoardStateHash getPawnHash() { return pawnHash; }
+			// has the current position occurred count times before
+			// only positions since the last capture or pawn move with the same side to move are scanned
+			bool isRepetition(int count = 1);
 			bool kingInCheck();
 			bool squareUnderAttack(int squareIndex, Color attackingSide);
-			// try to play move
-			// signal if it's invalid
+			// play pseudo legal move and pass the turn to the other side
+			// the move is not validated, use testPseudoLegalMove first
 			void playMove(Move move);
+			// take back the last move played by playMove
+			void unmakeMove();
 			bool testPseudoLegalMove(Move move);
+			// https://www.chessprogramming.org/0x88#Square_Relations
+			// can the piece standing on from attack to (both 0x88 indexes)
+			// answered with one lookup in the 0x88 difference table, sliders also walk the ray
+			bool pieceAttacksSquare(int from, int to);
+			// would the generator produce this move in the current position
+			// checks moves coming from outside the generator (hash move, killer moves)
+			// without generating all moves, legality still needs testPseudoLegalMove
+			bool isPseudoLegal(Move move);
+			// full move with the capture and pawn flags the generator would give it
+			// from the pieces of the current position, check it with isPseudoLegal
+			Move decodeMove(CompactMove move);
 			GameStatus gameStatus();
 			Color oppositeSide() { return currentPlayer == WHITE ? BLACK : WHITE; }
 			// try to play move and transfer into next move state
 			GameStatus playNextMove(ValidMove move, GameStatus previousGameStateStatus);
 			ValidMove findMove(IndexPair fromToPair);
+			// move in standard algebraic notation (Nbd7, exd8=Q+, O-O)
+			// looked up in the legal moves, not found if it is ambiguous
+			ValidMove findSanMove(const char* san, size_t length);
 			void printBoard();
 			void updateAllPossibleMoves();
         };
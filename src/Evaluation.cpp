@@ -0,0 +1,98 @@
+#include "Evaluation.h"
+
+namespace Chess {
+
+	int evaluate(BoardState& board, PawnTable& pawns) {
+		if (network.isLoaded())
+			return network.evaluate(board.updateAccumulator(), board.getPlayerColor());
+
+		PawnEntry& entry = pawns.probe(board);
+		int mg = board.getMgScore() + entry.mgScore + pawns.shelter(board, entry, WHITE) - pawns.shelter(board, entry, BLACK);
+		int eg = board.getEgScore() + entry.egScore;
+
+		// https://www.chessprogramming.org/Tapered_Eval
+		// blend of the middlegame and endgame sums by the material left on the board
+		// more than the start position (early promotions) counts as middlegame
+		int mgPhase = std::min(board.getPhase(), MAXPHASE);
+		int score = (mg * mgPhase + eg * (MAXPHASE - mgPhase)) / MAXPHASE;
+
+		return board.getPlayerColor() == WHITE ? score : -score;
+	}
+
+	int staticExchange(BoardState& board, Move move) {
+		// a king can only capture last, its value makes any recapture of it a loss
+		const int exchangeValues[6] = { pieceValues[KNIGHT], pieceValues[BISHOP], pieceValues[ROOK], pieceValues[QUEEN], 20000, pieceValues[PAWN] };
+		// least valuable attacker goes first
+		const int attackerOrder[6] = { PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING };
+
+		int from = x88ToSquare(move.move.byteData.from);
+		int to = x88ToSquare(move.move.byteData.to);
+		int type = move.move.byteData.type;
+		Color side = board.getPlayerColor();
+
+		Bitboard occupied = board.getOccupied() ^ squareBB(from);
+		int captured = EMPTY;
+
+		if (type & ENPASSANT) {
+			captured = PAWN;
+			occupied ^= squareBB(side == WHITE ? to - 8 : to + 8);
+		}
+		else if (type & CAPTURE)
+			captured = board.getPiece(move.move.byteData.to);
+
+		// gain[d] is what the side making capture d wins if the exchange stops after it
+		int gain[32];
+		int depth = 0;
+		int onSquare = board.getPiece(move.move.byteData.from);
+
+		gain[0] = captured == EMPTY ? 0 : exchangeValues[captured];
+		if (type & PROMOTE) {
+			onSquare = move.move.byteData.promote;
+			gain[0] += exchangeValues[onSquare] - exchangeValues[PAWN];
+		}
+
+		Bitboard diagonal = board.getPieces(WHITE, BISHOP) | board.getPieces(BLACK, BISHOP) | board.getPieces(WHITE, QUEEN) | board.getPieces(BLACK, QUEEN);
+		Bitboard straight = board.getPieces(WHITE, ROOK) | board.getPieces(BLACK, ROOK) | board.getPieces(WHITE, QUEEN) | board.getPieces(BLACK, QUEEN);
+		Bitboard attackers = board.attackersTo(to, occupied) & occupied;
+
+		while (depth < 31) {
+			side = side == WHITE ? BLACK : WHITE;
+			Bitboard own = attackers & board.getPieces(side);
+
+			if (!own)
+				break;
+
+			int piece = PAWN;
+			Bitboard pieceAttackers = 0;
+			for (int attacker : attackerOrder)
+				if ((pieceAttackers = own & board.getPieces(side, (Piece)attacker))) {
+					piece = attacker;
+					break;
+				}
+
+			depth++;
+			gain[depth] = exchangeValues[onSquare] - gain[depth - 1];
+
+			// the side capturing now loses whether it captures or not
+			// so the previous capture stands, the value of this one does not matter
+			if (std::max(-gain[depth - 1], gain[depth]) < 0) {
+				depth--;
+				break;
+			}
+
+			// sliders behind the capturing piece join the exchange
+			occupied ^= squareBB(lsb(pieceAttackers));
+			attackers |= (bishopAttacks(to, occupied) & diagonal) | (rookAttacks(to, occupied) & straight);
+			attackers &= occupied;
+			onSquare = piece;
+		}
+
+		// every side stops the exchange as soon as going on would lose
+		while (depth > 0) {
+			gain[depth - 1] = -std::max(-gain[depth - 1], gain[depth]);
+			depth--;
+		}
+
+		return gain[0];
+	}
+}
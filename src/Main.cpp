@@ -1,10 +1,208 @@
 #include "SimpleChess.h"
+#include "Uci.h"
+#include "FenReader.h"
+#include "PgnValidator.h"
+#include "Perft.h"
+#include <chrono>
+
+namespace Chess {
+
+	// perft with node count printed for every legal root move
+	// used to find the move in which the generator differs from reference counts
+	void perftDivide(BoardState& board, int depth, int threads, size_t hashMegabytes) {
+		MovePrompt prompt;
+		Perft perft(hashMegabytes);
+		PerftResult result;
+
+		perft.run(board, depth, threads, result);
+
+		for (int i = 0; i < result.moves.size(); i++)
+			cout << prompt.moveToString(result.moves[i]) << ": " << result.moveNodes[i] << endl;
+
+		cout << endl;
+		cout << "Moves: " << result.moves.size() << endl;
+		cout << "Nodes: " << result.nodes << endl;
+		cout << "Time: " << result.time << " ms" << endl;
+		cout << "NPS: " << (result.time > 0 ? result.nodes * 1000 / result.time : result.nodes) << endl;
+		cout << "Threads: " << result.threads << ", efficiency " << result.efficiency << "%" << endl;
+	}
+
+	// loads every position of a fen or epd file, measures the loading speed
+	void loadPositions(const string& path) {
+		FenReader reader;
+		BoardState board;
+		uint64_t positions = 0;
+
+		if (!reader.open(path)) {
+			cout << "Cannot open " << path << endl;
+			return;
+		}
+
+		auto start = std::chrono::steady_clock::now();
+
+		while (reader.next(board))
+			++positions;
+
+		auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+		cout << "Positions: " << positions << endl;
+		cout << "Invalid: " << reader.getInvalidLines() << endl;
+		cout << "Time: " << elapsed << " ms" << endl;
+		cout << "Positions per second: " << (elapsed > 0 ? positions * 1000 / elapsed : positions) << endl;
+	}
+
+	// replays every game of a pgn file, reports illegal games and how the games ended
+	void validateGames(const string& path, int threads) {
+		PgnValidator validator;
+		PgnStats stats;
+
+		auto start = std::chrono::steady_clock::now();
+
+		if (!validator.run(path, threads, stats)) {
+			cout << "Cannot open " << path << endl;
+			return;
+		}
+
+		auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+		cout << "Games: " << stats.games << endl;
+		cout << "Moves: " << stats.moves << endl;
+		cout << "Illegal: " << stats.illegal << endl;
+		cout << "Checkmate: " << stats.status[CHECKMATE] << endl;
+		cout << "Stalemate: " << stats.status[STALEMATE] << endl;
+		cout << "Draw by repetition: " << stats.status[DRAWBYREPETITION] << endl;
+		cout << "Draw by 50 moves: " << stats.status[DRAWBY50MOVES] << endl;
+		cout << "Not over: " << stats.status[NOTOVER] << endl;
+		cout << "Time: " << elapsed << " ms" << endl;
+		cout << "Games per second: " << (elapsed > 0 ? stats.games * 1000 / elapsed : stats.games) << endl;
+	}
+
+	// play moves in long algebraic notation (e2e4, e7e8q) from the start position
+	bool playMoves(BoardState& board, int count, char* moves[]) {
+		MovePrompt prompt;
+
+		for (int i = 0; i < count; i++) {
+			string text = moves[i];
+
+			if (text.size() < 4) {
+				cout << "Invalid move: " << text << endl;
+				return false;
+			}
+
+			board.updateAllPossibleMoves();
+			ValidMove vmove = board.findMove(prompt.parseMove(text));
+
+			if (vmove.first && (vmove.second.move.byteData.type & PROMOTE))
+				vmove.second.move.byteData.promote = text.size() > 4 ? prompt.parsePromotionMove(text.substr(4)) : QUEEN;
+
+			if (board.playNextMove(vmove, NOTOVER) == INVALIDMOVE) {
+				cout << "Invalid move: " << text << endl;
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
 
 int main(int argc, char* argv[]) {
 
+	// SimpleChess uci
+	if (argc >= 2 && std::string(argv[1]) == "uci") {
+		Chess::Uci uci;
+		uci.loop();
+		return 0;
+	}
+
+	// SimpleChess fens <file>
+	if (argc >= 3 && std::string(argv[1]) == "fens") {
+		Chess::loadPositions(argv[2]);
+		return 0;
+	}
+
+	// SimpleChess pgn <file> [threads]
+	if (argc >= 3 && std::string(argv[1]) == "pgn") {
+		int threads = argc >= 4 ? atoi(argv[3]) : (int)std::thread::hardware_concurrency();
+		Chess::validateGames(argv[2], std::max(threads, 1));
+		return 0;
+	}
+
+	// SimpleChess perft [-threads n] [-hash mb] <depth> [moves...]
+	if (argc >= 3 && std::string(argv[1]) == "perft") {
+		int threads = (int)std::thread::hardware_concurrency();
+		int hash = 0;
+
+		while (argc >= 5 && argv[2][0] == '-') {
+			std::string option = argv[2];
+
+			if (option == "-threads")
+				threads = atoi(argv[3]);
+			else if (option == "-hash")
+				hash = std::max(0, atoi(argv[3]));
+
+			argc -= 2;
+			argv += 2;
+		}
+
+		Chess::BoardState board;
+
+		if (!Chess::playMoves(board, argc - 3, argv + 3))
+			return 1;
+
+		Chess::perftDivide(board, std::max(1, atoi(argv[2])), std::max(threads, 1), hash);
+		return 0;
+	}
+
+	// SimpleChess analyze [-threads n] [-eval file] <depth> [moves...]
+	if (argc >= 3 && std::string(argv[1]) == "analyze") {
+		Chess::SearchLimits limits;
+
+		while (argc >= 5 && argv[2][0] == '-') {
+			std::string option = argv[2];
+
+			if (option == "-threads")
+				limits.threads = std::max(1, atoi(argv[3]));
+			else if (option == "-eval" && !Chess::network.load(argv[3])) {
+				std::cout << "Cannot load network from " << argv[3] << std::endl;
+				return 1;
+			}
+
+			argc -= 2;
+			argv += 2;
+		}
+
+		Chess::BoardState board;
+
+		if (!Chess::playMoves(board, argc - 3, argv + 3))
+			return 1;
+
+		limits.depth = std::max(1, atoi(argv[2]));
+		limits.printInfo = true;
+
+		Chess::TranspositionTable table;
+		Chess::Search search(board, table);
+		Chess::SearchResult result = search.think(limits);
+
+		Chess::MovePrompt prompt;
+		std::cout << "bestmove " << prompt.moveToString(result.bestMove) << std::endl;
+		return 0;
+	}
+
+	// SimpleChess computer <white|black> [movetime ms] [threads]
+	if (argc >= 3 && std::string(argv[1]) == "computer") {
+		Chess::SearchLimits limits;
+		limits.movetime = argc >= 4 ? std::max(1, atoi(argv[3])) : 1000;
+		limits.threads = argc >= 5 ? std::max(1, atoi(argv[4])) : 1;
+
+		Chess::SimpleChess game(std::string(argv[2]) == "black" ? Chess::BLACK : Chess::WHITE, limits);
+
+		game.play();
+		return 0;
+	}
+
 	Chess::SimpleChess game;
 	
 	game.play();
 	
 	return 0;
-}
\ No newline at end of file
+}
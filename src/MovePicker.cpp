@@ -0,0 +1,149 @@
+#include "MovePicker.h"
+
+namespace Chess {
+
+	MovePicker::MovePicker(BoardState& board, CompactMove hashMove, const CompactMove* killers, const int (*history)[64]) :
+		board(board), stage(HASHSTAGE), hashMove(hashMove), history(history), capturesOnly(false), index(0) {
+		this->killers[0] = killers[0];
+		this->killers[1] = killers[1];
+	}
+
+	MovePicker::MovePicker(BoardState& board, bool inCheck, const int (*history)[64]) :
+		board(board), stage(GENCAPTURESSTAGE), hashMove(), history(history), capturesOnly(!inCheck), index(0) {
+		killers[0] = killers[1] = CompactMove();
+	}
+
+	bool MovePicker::isLegal(Move move) {
+		return board.isPseudoLegal(move) && board.testPseudoLegalMove(move);
+	}
+
+	bool MovePicker::isSearched(CompactMove move) {
+		return move == hashMove || move == killers[0] || move == killers[1];
+	}
+
+	void MovePicker::scoreCaptures() {
+		for (int i = 0; i < moves.size(); i++) {
+			Move move = moves[i];
+			int type = move.move.byteData.type;
+			int victim = type & ENPASSANT ? PAWN : type & CAPTURE ? board.getPiece(move.move.byteData.to) : EMPTY;
+			int gain = victim == EMPTY ? 0 : pieceValues[victim] * 16 - pieceValues[board.getPiece(move.move.byteData.from)] / 16;
+
+			if (type & PROMOTE)
+				gain += (pieceValues[QUEEN] - pieceValues[PAWN]) * 16;
+
+			scores[i] = gain;
+		}
+	}
+
+	void MovePicker::scoreQuiets() {
+		for (int i = 0; i < moves.size(); i++)
+			scores[i] = history[x88ToSquare(moves[i].move.byteData.from)][x88ToSquare(moves[i].move.byteData.to)];
+	}
+
+	Move MovePicker::pickBest() {
+		int best = index;
+
+		for (int i = index + 1; i < moves.size(); i++)
+			if (scores[i] > scores[best])
+				best = i;
+
+		std::swap(moves[index], moves[best]);
+		std::swap(scores[index], scores[best]);
+		return moves[index++];
+	}
+
+	bool MovePicker::next(Move& move) {
+		switch (stage) {
+		case HASHSTAGE:
+			stage = GENCAPTURESSTAGE;
+			if (hashMove.data) {
+				move = board.decodeMove(hashMove);
+				if (isLegal(move))
+					return true;
+			}
+			// fall through
+
+		case GENCAPTURESSTAGE: {
+			board.generateLegalCaptures(moves);
+
+			// underpromotions are moved out of the list, the quiescence search drops them
+			int kept = 0;
+			for (int i = 0; i < moves.size(); i++) {
+				if ((moves[i].move.byteData.type & PROMOTE) && moves[i].move.byteData.promote != QUEEN) {
+					if (!capturesOnly)
+						underpromotions.push(moves[i]);
+				}
+				else
+					moves[kept++] = moves[i];
+			}
+			moves.count = kept;
+
+			scoreCaptures();
+			index = 0;
+			stage = CAPTURESSTAGE;
+		}
+			// fall through
+
+		case CAPTURESSTAGE:
+			while (index < moves.size()) {
+				move = pickBest();
+				if (CompactMove(move) != hashMove)
+					return true;
+			}
+
+			if (capturesOnly) {
+				stage = DONESTAGE;
+				return false;
+			}
+
+			index = 0;
+			stage = KILLERSSTAGE;
+			// fall through
+
+		case KILLERSSTAGE:
+			// killers are quiet moves, a killer that captures here was already a capture
+			while (index < 2) {
+				CompactMove killer = killers[index++];
+
+				if (!killer.data || killer == hashMove || (index == 2 && killer == killers[0]))
+					continue;
+
+				move = board.decodeMove(killer);
+				if (!(move.move.byteData.type & (CAPTURE | PROMOTE)) && isLegal(move))
+					return true;
+			}
+			stage = GENQUIETSSTAGE;
+			// fall through
+
+		case GENQUIETSSTAGE:
+			board.generateLegalQuiets(moves);
+			scoreQuiets();
+			index = 0;
+			stage = QUIETSSTAGE;
+			// fall through
+
+		case QUIETSSTAGE:
+			while (index < moves.size()) {
+				move = pickBest();
+				if (!isSearched(CompactMove(move)))
+					return true;
+			}
+
+			index = 0;
+			stage = UNDERPROMOTIONSSTAGE;
+			// fall through
+
+		case UNDERPROMOTIONSSTAGE:
+			while (index < underpromotions.size()) {
+				move = underpromotions[index++];
+				if (CompactMove(move) != hashMove)
+					return true;
+			}
+			stage = DONESTAGE;
+			// fall through
+
+		default:
+			return false;
+		}
+	}
+}
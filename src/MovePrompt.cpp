@@ -50,6 +50,23 @@ namespace Chess {
 		return pair;
 	}
 
+	string MovePrompt::moveToString(Move move) {
+		string text;
+		int from = move.move.byteData.from;
+		int to = move.move.byteData.to;
+
+		text += (char)('a' + (from & 7));
+		text += (char)('1' + (from >> 4));
+		text += (char)('a' + (to & 7));
+		text += (char)('1' + (to >> 4));
+
+		int promote = move.move.byteData.promote;
+		if ((move.move.byteData.type & PROMOTE) && promote >= KNIGHT && promote <= QUEEN)
+			text += "nbrq"[promote - KNIGHT];
+
+		return text;
+	}
+
 	string MovePrompt::readPromotionMove() {
 		string move;
 
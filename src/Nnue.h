@@ -0,0 +1,97 @@
+#ifndef NNUE_H
+#define NNUE_H
+
+#include "Bitboard.h"
+
+// https://www.chessprogramming.org/NNUE
+// the widest instruction set the compiler is allowed to use is picked at compile time
+// /arch:AVX2 or -mavx2 for AVX2, -mssse3 (or /arch:AVX) for SSSE3, otherwise plain C++
+#if defined(__AVX2__)
+#define NNUE_AVX2
+#include <immintrin.h>
+#elif defined(__SSSE3__) || defined(__AVX__)
+#define NNUE_SSSE3
+#include <tmmintrin.h>
+#endif
+
+namespace Chess {
+
+	// HalfKP inputs, one for every own king square, non king piece and square
+	// king squares and piece squares are seen from the perspective's side of the board
+	const int NNUE_INPUTS = 64 * 10 * 64;
+	// first hidden layer, the accumulator of one perspective
+	const int NNUE_L1 = 256;
+	const int NNUE_L2 = 32;
+	const int NNUE_L3 = 32;
+
+	// https://www.chessprogramming.org/NNUE#Quantization
+	// hidden layer sums are divided by 2^WEIGHTSHIFT, the output by OUTPUTSCALE
+	const int NNUE_WEIGHTSHIFT = 6;
+	const int NNUE_OUTPUTSCALE = 16;
+
+	// input of the king relative feature transformer
+	// square and kingSquare are 0-63 indexes, piece is not the king
+	inline int featureIndex(Color perspective, int kingSquare, Color color, int piece, int square) {
+		if (perspective == BLACK) {
+			kingSquare ^= 56;
+			square ^= 56;
+		}
+
+		int kind = (piece == PAWN ? 4 : piece) * 2 + (color != perspective);
+		return kingSquare * 640 + kind * 64 + square;
+	}
+
+	// first layer output of both perspectives for one position
+	// key is the hash of the position the values of a perspective were computed for
+	// generation is the network they were computed with, values of an older network are stale
+	struct Accumulator {
+		int16_t values[2][NNUE_L1];
+		BoardStateHash key[2];
+		uint32_t generation[2];
+	};
+
+	// https://www.chessprogramming.org/Stockfish_NNUE
+	// 2 x 40960 -> 2 x 256 -> 32 -> 32 -> 1, clipped relu between the layers
+	// weights are read from a file, without one the evaluation stays with the piece square tables
+	//
+	// file layout, little endian:
+	// "SCNN", uint32 version 1, uint32 NNUE_L1, NNUE_L2, NNUE_L3
+	// int16 feature biases [L1], int16 feature weights [INPUTS][L1]
+	// int32 biases [L2], int8 weights [L2][2 * L1]
+	// int32 biases [L3], int8 weights [L3][L2]
+	// int32 output bias, int8 output weights [L3]
+	class Network {
+	private:
+		std::vector<int16_t> featureBiases;
+		std::vector<int16_t> featureWeights;
+		std::vector<int32_t> biases2;
+		std::vector<int8_t> weights2;
+		std::vector<int32_t> biases3;
+		std::vector<int8_t> weights3;
+		int32_t outputBias;
+		std::vector<int8_t> outputWeights;
+		bool loaded;
+		// counts successful loads
+		uint32_t generation;
+
+	public:
+		Network();
+		// keeps the old weights if the file can not be read or does not fit the layer sizes
+		bool load(const std::string& path);
+		bool isLoaded() const { return loaded; }
+		uint32_t getGeneration() const { return generation; }
+
+		// values start from the biases, features are added one by one
+		void refresh(int16_t* values) const;
+		void addFeature(int16_t* values, int feature) const;
+		// output = input with the features of one move added and removed, one pass over the layer
+		void update(const int16_t* input, int16_t* output, const int* added, int addedCount, const int* removed, int removedCount) const;
+		// score in centipawns from the side to move's point of view
+		int evaluate(const Accumulator& accumulator, Color sideToMove) const;
+	};
+
+	// shared by every board and search thread, only read once it is loaded
+	extern Network network;
+}
+
+#endif // NNUE_H
@@ -0,0 +1,143 @@
+#include "Pawns.h"
+
+namespace Chess {
+
+	// https://www.chessprogramming.org/Pawn_Structure
+	// middlegame and endgame values in centipawns, penalties are negative
+	const int DOUBLEDMG = -10;
+	const int DOUBLEDEG = -25;
+	const int ISOLATEDMG = -5;
+	const int ISOLATEDEG = -15;
+	// by rank from the side of the pawn, the piece square tables already reward advancing
+	const int PASSEDMG[8] = { 0, 0, 5, 10, 20, 35, 60, 0 };
+	const int PASSEDEG[8] = { 0, 10, 15, 25, 45, 75, 120, 0 };
+
+	// https://www.chessprogramming.org/King_Safety#Pawn_Shield
+	// own pawns one and two ranks in front of the king, on its file and the files next to it
+	const int SHIELDNEAR = 10;
+	const int SHIELDFAR = 5;
+	// a file next to the king without own pawns
+	const int SHIELDOPENFILE = -10;
+
+	static Bitboard fileBB(int file) { return FILEA_BB << file; }
+
+	static Bitboard adjacentFilesBB(int file) {
+		return (file > 0 ? fileBB(file - 1) : 0) | (file < 7 ? fileBB(file + 1) : 0);
+	}
+
+	// ranks in front of the rank from the side of the color
+	static Bitboard forwardRanksBB(Color color, int rank) {
+		if (color == WHITE)
+			return rank == 7 ? 0 : ~0ULL << (8 * (rank + 1));
+		return rank == 0 ? 0 : ~0ULL >> (8 * (8 - rank));
+	}
+
+	PawnTable::PawnTable(size_t size) {
+		size_t count = 1;
+		while (count * 2 <= size)
+			count *= 2;
+
+		entries.resize(count);
+		mask = count - 1;
+
+		// the key of no pawns at all is zero, so a zero key has to miss until it is stored
+		for (auto& entry : entries)
+			entry.key = ~0ULL;
+	}
+
+	PawnEntry& PawnTable::probe(BoardState& board) {
+		BoardStateHash key = board.getPawnHash();
+		PawnEntry& entry = entries[key & mask];
+
+		if (entry.key != key) {
+			entry.key = key;
+			evaluatePawns(board, entry);
+		}
+
+		return entry;
+	}
+
+	void PawnTable::evaluatePawns(BoardState& board, PawnEntry& entry) {
+		entry.mgScore = 0;
+		entry.egScore = 0;
+		entry.shelterKing[WHITE] = entry.shelterKing[BLACK] = EMPTY;
+
+		for (int c = WHITE; c <= BLACK; c++) {
+			Color color = (Color)c;
+			Bitboard own = board.getPieces(color, PAWN);
+			Bitboard enemy = board.getPieces(color == WHITE ? BLACK : WHITE, PAWN);
+			int sign = color == WHITE ? 1 : -1;
+			int mg = 0, eg = 0;
+
+			entry.files[color] = 0;
+
+			for (Bitboard b = own; b;)
+				entry.files[color] |= 1 << (popLsb(b) & 7);
+
+			for (Bitboard b = own; b;) {
+				int square = popLsb(b);
+				int file = square & 7;
+				int rank = square >> 3;
+				Bitboard front = forwardRanksBB(color, rank);
+
+				// the pawn further back is the doubled one, it is blocked by its own pawn
+				if (own & front & fileBB(file)) {
+					mg += DOUBLEDMG;
+					eg += DOUBLEDEG;
+				}
+
+				if (!(entry.files[color] & ((file > 0 ? 1 << (file - 1) : 0) | (file < 7 ? 1 << (file + 1) : 0)))) {
+					mg += ISOLATEDMG;
+					eg += ISOLATEDEG;
+				}
+
+				// no enemy pawn can stop or capture it on its way
+				if (!(enemy & front & (fileBB(file) | adjacentFilesBB(file)))) {
+					int relativeRank = color == WHITE ? rank : 7 - rank;
+					mg += PASSEDMG[relativeRank];
+					eg += PASSEDEG[relativeRank];
+				}
+			}
+
+			entry.mgScore += sign * mg;
+			entry.egScore += sign * eg;
+		}
+	}
+
+	int PawnTable::shelter(BoardState& board, PawnEntry& entry, Color color) {
+		int king = x88ToSquare(board.getKingSquare(color));
+
+		if (entry.shelterKing[color] != king) {
+			entry.shelterKing[color] = (int8_t)king;
+			entry.shelter[color] = evaluateShelter(board, entry, color);
+		}
+
+		return entry.shelter[color];
+	}
+
+	int PawnTable::evaluateShelter(BoardState& board, PawnEntry& entry, Color color) {
+		int king = x88ToSquare(board.getKingSquare(color));
+		int kingFile = king & 7;
+		int kingRank = king >> 3;
+		int forward = color == WHITE ? 8 : -8;
+		Bitboard own = board.getPieces(color, PAWN);
+		int score = 0;
+
+		// a king in front of its pawns has no shelter to count
+		if ((color == WHITE ? kingRank : 7 - kingRank) > 1)
+			return 0;
+
+		for (int file = std::max(kingFile - 1, 0); file <= std::min(kingFile + 1, 7); file++) {
+			int square = kingRank * 8 + file;
+
+			if (!(entry.files[color] & (1 << file)))
+				score += SHIELDOPENFILE;
+			else if (own & squareBB(square + forward))
+				score += SHIELDNEAR;
+			else if (own & squareBB(square + 2 * forward))
+				score += SHIELDFAR;
+		}
+
+		return score;
+	}
+}
@@ -0,0 +1,46 @@
+#ifndef PAWNS_H
+#define PAWNS_H
+
+#include "BoardState.h"
+
+namespace Chess {
+
+	// pawn structure of one position, depends on the pawns only
+	// except the shelter, which is computed again when its king has moved
+	struct PawnEntry {
+		BoardStateHash key;
+		// passed, isolated and doubled pawns, white's point of view
+		int mgScore;
+		int egScore;
+		// bit for every file with a pawn of the color
+		uint8_t files[2];
+		// king square (0-63) the shelter was computed for, EMPTY if none
+		int8_t shelterKing[2];
+		// pawns in front of the king, middlegame only
+		int shelter[2];
+	};
+
+	// https://www.chessprogramming.org/Pawn_Hash_Table
+	// the pawns change in few of the moves of a search
+	// so their evaluation is almost always found here
+	// not shared between threads, every search has its own table
+	class PawnTable {
+	private:
+		std::vector<PawnEntry> entries;
+		size_t mask;
+
+	private:
+		void evaluatePawns(BoardState& board, PawnEntry& entry);
+		int evaluateShelter(BoardState& board, PawnEntry& entry, Color color);
+
+	public:
+		// rounded down to a power of two
+		explicit PawnTable(size_t size = 32768);
+		// entry of the pawn structure of the board, evaluated on a miss
+		PawnEntry& probe(BoardState& board);
+		// shelter of the king of the color from the entry, computed if the king has moved
+		int shelter(BoardState& board, PawnEntry& entry, Color color);
+	};
+}
+
+#endif // PAWNS_H
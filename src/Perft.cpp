@@ -0,0 +1,208 @@
+#include "Perft.h"
+#include <chrono>
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace Chess {
+
+	// tasks for every worker before the tree is split one ply deeper
+	// small subtrees at the end keep the workers busy until the last one finishes
+	const size_t TASKSPERTHREAD = 16;
+
+	// cpu time used by the calling thread in microseconds
+	// unlike wall clock time it does not grow while the thread waits for a core
+	static int64_t threadCpuTime() {
+#if defined(_WIN32)
+		FILETIME creation, exited, kernel, user;
+		GetThreadTimes(GetCurrentThread(), &creation, &exited, &kernel, &user);
+		// 100 nanosecond units
+		auto ticks = [](const FILETIME& time) { return (int64_t)time.dwHighDateTime << 32 | time.dwLowDateTime; };
+		return (ticks(kernel) + ticks(user)) / 10;
+#else
+		timespec time;
+		clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+		return (int64_t)time.tv_sec * 1000000 + time.tv_nsec / 1000;
+#endif
+	}
+
+	uint64_t perft(BoardState& board, int depth) {
+		uint64_t nodes = 0;
+		MoveList moves;
+		board.generateLegalMoves(moves);
+
+		if (depth == 1)
+			return moves.size();
+
+		for (auto& move : moves) {
+			board.playMove(move);
+			nodes += perft(board, depth - 1);
+			board.unmakeMove();
+		}
+
+		return nodes;
+	}
+
+	PerftTable::PerftTable(size_t megabytes) {
+		size_t count = std::max<size_t>(megabytes, 1) * 1024 * 1024 / sizeof(Slot);
+
+		size_t size = 1;
+		while (size * 2 <= count)
+			size *= 2;
+
+		// value initialized, every slot starts with a zero check and count
+		slots.reset(new Slot[size]());
+		mask = size - 1;
+	}
+
+	bool PerftTable::probe(BoardStateHash key, int depth, uint64_t& nodes) {
+		uint64_t k = mix(key, depth);
+		Slot& slot = slots[k & mask];
+		uint64_t n = slot.nodes.load(std::memory_order_relaxed);
+
+		if ((slot.check.load(std::memory_order_relaxed) ^ n) != k)
+			return false;
+
+		nodes = n;
+		return true;
+	}
+
+	void PerftTable::store(BoardStateHash key, int depth, uint64_t nodes) {
+		uint64_t k = mix(key, depth);
+		Slot& slot = slots[k & mask];
+
+		slot.check.store(k ^ nodes, std::memory_order_relaxed);
+		slot.nodes.store(nodes, std::memory_order_relaxed);
+	}
+
+	uint64_t perft(BoardState& board, int depth, PerftTable& table) {
+		uint64_t nodes = 0;
+
+		// bulk counting is cheaper than a probe, the last ply is never stored
+		if (depth > 1 && table.probe(board.getHash(), depth, nodes))
+			return nodes;
+
+		MoveList moves;
+		board.generateLegalMoves(moves);
+
+		if (depth == 1)
+			return moves.size();
+
+		for (auto& move : moves) {
+			board.playMove(move);
+			nodes += perft(board, depth - 1, table);
+			board.unmakeMove();
+		}
+
+		table.store(board.getHash(), depth, nodes);
+		return nodes;
+	}
+
+	Perft::Perft(size_t hashMegabytes) : nextTask(0) {
+		if (hashMegabytes > 0)
+			table.reset(new PerftTable(hashMegabytes));
+	}
+
+	void Perft::run(BoardState& board, int depth, int threads, PerftResult& result) {
+		auto start = std::chrono::steady_clock::now();
+
+		threads = std::max(threads, 1);
+		result.threads = threads;
+		result.nodes = 0;
+		result.efficiency = 100;
+
+		board.generateLegalMoves(result.moves);
+		result.moveNodes.assign(result.moves.size(), depth > 1 ? 0 : 1);
+
+		tasks.clear();
+		if (depth > 1)
+			for (int i = 0; i < result.moves.size(); i++) {
+				tasks.push_back({ Position(), i, 0 });
+				board.playMove(result.moves[i]);
+				board.getPosition(tasks.back().position);
+				board.unmakeMove();
+			}
+
+		// every task has to keep at least two plies to count
+		// the last ply is counted in bulk so splitting it gains nothing
+		// tasks are set up on a scratch board, the board of the caller stays as it is
+		BoardState scratch;
+		int splitDepth = 1;
+		while (tasks.size() < threads * TASKSPERTHREAD && depth - splitDepth > 2) {
+			split(scratch);
+			splitDepth++;
+		}
+
+		std::vector<WorkerStats> workerStats(threads);
+
+		if (!tasks.empty()) {
+			nextTask = 0;
+			std::vector<std::thread> workers;
+
+			for (int i = 0; i < threads; i++)
+				workers.emplace_back(&Perft::worker, this, depth - splitDepth, std::ref(workerStats[i]));
+
+			for (auto& worker : workers)
+				worker.join();
+		}
+
+		for (auto& task : tasks)
+			result.moveNodes[task.rootIndex] += task.nodes;
+
+		if (tasks.empty())
+			result.nodes = depth > 1 ? 0 : result.moves.size();
+
+		for (auto& s : workerStats)
+			result.nodes += s.nodes;
+
+		auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+		result.time = elapsed / 1000;
+
+		int64_t cpuTime = 0;
+		for (auto& s : workerStats)
+			cpuTime += s.cpuTime;
+
+		if (elapsed > 0 && !tasks.empty())
+			result.efficiency = (int)std::min<int64_t>(100, cpuTime * 100 / (elapsed * threads));
+	}
+
+	void Perft::split(BoardState& board) {
+		std::vector<Task> deeper;
+		MoveList moves;
+
+		for (auto& task : tasks) {
+			board.setPosition(task.position);
+
+			// a mate or stalemate has no leaf nodes below, its task is dropped
+			board.generateLegalMoves(moves);
+			for (auto& move : moves) {
+				deeper.push_back({ Position(), task.rootIndex, 0 });
+				board.playMove(move);
+				board.getPosition(deeper.back().position);
+				board.unmakeMove();
+			}
+		}
+
+		tasks.swap(deeper);
+	}
+
+	void Perft::worker(int depth, WorkerStats& stats) {
+		int64_t start = threadCpuTime();
+		BoardState board;
+
+		// tasks are written only by the worker that took them
+		for (size_t i = nextTask++; i < tasks.size(); i = nextTask++) {
+			Task& task = tasks[i];
+
+			board.setPosition(task.position);
+			task.nodes = table ? perft(board, depth, *table) : perft(board, depth);
+			stats.nodes += task.nodes;
+		}
+
+		stats.cpuTime = threadCpuTime() - start;
+	}
+}
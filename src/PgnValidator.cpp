@@ -0,0 +1,241 @@
+#include "PgnValidator.h"
+
+namespace Chess {
+
+	// enough games in flight to keep every worker busy without holding the whole file
+	const size_t BATCHSIZE = 256;
+	const size_t MAXBATCHES = 64;
+
+	void PgnStats::add(const PgnStats& other) {
+		games += other.games;
+		moves += other.moves;
+		illegal += other.illegal;
+		for (int i = 0; i <= NOTOVER; i++)
+			status[i] += other.status[i];
+	}
+
+	// true if the last token of a movetext line is a game termination marker
+	static bool endsGame(const string& line) {
+		size_t end = line.find_last_not_of(" \t\r");
+		if (end == string::npos)
+			return false;
+
+		size_t start = line.find_last_of(" \t", end);
+		start = start == string::npos ? 0 : start + 1;
+		string token = line.substr(start, end - start + 1);
+		return token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*";
+	}
+
+	PgnValidator::PgnValidator() {
+		endOfInput = false;
+	}
+
+	bool PgnValidator::run(const string& path, int threads, PgnStats& stats) {
+		std::ifstream file(path, std::ios::binary);
+
+		if (!file)
+			return false;
+
+		threads = std::max(threads, 1);
+		endOfInput = false;
+
+		std::vector<PgnStats> workerStats(threads);
+		std::vector<std::thread> workers;
+
+		for (int i = 0; i < threads; i++)
+			workers.emplace_back(&PgnValidator::worker, this, std::ref(workerStats[i]));
+
+		// a game ends with its termination marker, at the empty line after its movetext
+		// or where a tag after movetext starts the next game, with or without tags of its own
+		Batch batch;
+		batch.firstGame = 1;
+		uint64_t gameNumber = 0;
+		string line, game;
+		bool movetext = false;
+
+		auto endGame = [&]() {
+			batch.games.push_back(std::move(game));
+			game.clear();
+			movetext = false;
+
+			if (++gameNumber % BATCHSIZE == 0) {
+				push(batch);
+				batch.firstGame = gameNumber + 1;
+			}
+		};
+
+		while (std::getline(file, line)) {
+			bool empty = line.find_first_not_of(" \t\r") == string::npos;
+			bool tag = !empty && line[line.find_first_not_of(" \t")] == '[';
+
+			if (movetext && (tag || empty))
+				endGame();
+
+			if (!empty && !tag)
+				movetext = true;
+
+			game += line;
+			game += '\n';
+
+			if (movetext && endsGame(line))
+				endGame();
+		}
+
+		if (movetext)
+			batch.games.push_back(std::move(game));
+		push(batch);
+
+		{
+			std::lock_guard<std::mutex> lock(queueMutex);
+			endOfInput = true;
+		}
+		queueNotEmpty.notify_all();
+
+		for (auto& worker : workers)
+			worker.join();
+
+		for (auto& s : workerStats)
+			stats.add(s);
+
+		return true;
+	}
+
+	void PgnValidator::push(Batch& batch) {
+		if (batch.games.empty())
+			return;
+
+		std::unique_lock<std::mutex> lock(queueMutex);
+		queueNotFull.wait(lock, [this] { return queue.size() < MAXBATCHES; });
+		queue.push_back(std::move(batch));
+		lock.unlock();
+		queueNotEmpty.notify_one();
+
+		batch.games.clear();
+		batch.games.reserve(BATCHSIZE);
+	}
+
+	void PgnValidator::worker(PgnStats& stats) {
+		// one board for every game of the worker, loadFen resets it
+		// constructing a BoardState fills the zobrist tables which is slow compared to a game
+		BoardState board;
+
+		while (true) {
+			std::unique_lock<std::mutex> lock(queueMutex);
+			queueNotEmpty.wait(lock, [this] { return !queue.empty() || endOfInput; });
+
+			if (queue.empty())
+				return;
+
+			Batch batch = std::move(queue.front());
+			queue.pop_front();
+			lock.unlock();
+			queueNotFull.notify_one();
+
+			for (size_t i = 0; i < batch.games.size(); i++)
+				replay(board, batch.games[i], batch.firstGame + i, stats);
+		}
+	}
+
+	void PgnValidator::report(uint64_t gameNumber, int ply, const string& message) {
+		std::lock_guard<std::mutex> lock(outputMutex);
+		cout << "Game " << gameNumber << ", ply " << ply + 1 << ": " << message << endl;
+	}
+
+	void PgnValidator::replay(BoardState& board, const string& game, uint64_t gameNumber, PgnStats& stats) {
+		const char* c = game.c_str();
+		int ply = 0;
+		GameStatus status = NOTOVER;
+
+		stats.games++;
+		board.loadFen(STARTFEN);
+
+		while (*c) {
+			// tag pair, only the fen tag changes the replay
+			if (*c == '[') {
+				const char* end = strchr(c, ']');
+				end = end ? end : c + strlen(c);
+
+				if (strncmp(c, "[FEN \"", 6) == 0) {
+					string fen(c + 6, std::find(c + 6, end, '"'));
+
+					if (!board.loadFen(fen)) {
+						report(gameNumber, ply, "invalid fen " + fen);
+						stats.illegal++;
+						return;
+					}
+				}
+
+				c = *end ? end + 1 : end;
+			}
+			// comments
+			else if (*c == '{') {
+				const char* end = strchr(c, '}');
+				c = end ? end + 1 : c + strlen(c);
+			}
+			else if (*c == ';' || *c == '%') {
+				const char* end = strchr(c, '\n');
+				c = end ? end : c + strlen(c);
+			}
+			// variations are not replayed, skipped with everything nested in them
+			else if (*c == '(') {
+				int depth = 0;
+				do {
+					if (*c == '(')
+						depth++;
+					else if (*c == ')')
+						depth--;
+					else if (*c == '{') {
+						const char* end = strchr(c, '}');
+						c = end ? end : c + strlen(c) - 1;
+					}
+					c++;
+				} while (*c && depth > 0);
+			}
+			else if (isspace((unsigned char)*c) || *c == ')')
+				c++;
+			else {
+				const char* start = c;
+				while (*c && !isspace((unsigned char)*c) && !strchr("{}();[", *c))
+					c++;
+				size_t length = c - start;
+
+				// numeric annotation glyph, enpassant mark after the move
+				if (*start == '$' || (length == 4 && strncmp(start, "e.p.", 4) == 0))
+					continue;
+
+				string token(start, length);
+
+				// game termination marker
+				if (token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*")
+					break;
+
+				// move number, 12. or 12... possibly glued to the move
+				// castling written with zeros is a move
+				while (length > 0 && strncmp(start, "0-0", 3) != 0 && (isdigit((unsigned char)*start) || *start == '.')) {
+					start++;
+					length--;
+				}
+				if (length == 0)
+					continue;
+
+				board.updateAllPossibleMoves();
+				ValidMove vmove = board.findSanMove(start, length);
+
+				if (!vmove.first) {
+					report(gameNumber, ply, "illegal move " + string(start, length));
+					stats.illegal++;
+					return;
+				}
+
+				status = board.playNextMove(vmove, status);
+				stats.moves++;
+				ply++;
+			}
+		}
+
+		// a repetition on the last move is kept, otherwise the position decides
+		board.updateAllPossibleMoves();
+		GameStatus finalStatus = board.gameStatus();
+		stats.status[finalStatus == NOTOVER ? status : finalStatus]++;
+	}
+}
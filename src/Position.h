@@ -0,0 +1,31 @@
+#ifndef POSITION_H
+#define POSITION_H
+
+#include "Bitboard.h"
+#include <type_traits>
+
+namespace Chess {
+
+	// https://www.chessprogramming.org/Copy-Make
+	// everything that describes a position in one small block without pointers
+	// copied with a plain memcpy, so perft tasks and search threads clone positions cheaply
+	// BoardState::getPosition fills it, BoardState::setPosition sets a board up from it
+	struct Position {
+		Bitboard pieces[2][6];
+		// piece type on every square (0-63 index), EMPTY if there is none
+		// the color comes from the bitboards
+		int8_t board[64];
+		BoardStateHash hash;
+		// plies played since the start of the game, gives the fullmove number
+		uint16_t ply;
+		uint16_t fiftyMoves;
+		int8_t player;
+		int8_t castlingRights;
+		int8_t enpassantSquare; // 0x88 index, EMPTY if there is none
+	};
+
+	static_assert(std::is_trivially_copyable<Position>::value, "Position has to be copyable with memcpy");
+	static_assert(sizeof(Position) <= 176, "Position has to stay within three cache lines");
+}
+
+#endif // POSITION_H
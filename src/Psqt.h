@@ -0,0 +1,33 @@
+#ifndef PSQT_H
+#define PSQT_H
+
+#include "Bitboard.h"
+
+namespace Chess {
+
+	// https://www.chessprogramming.org/Piece-Square_Tables
+	// material plus the piece square bonus of a piece standing on a square (0-63 index)
+	// one value for the middlegame, one for the endgame
+	// positive for white and negative for black so the score of a position is a plain sum
+	extern int psqtMg[2][6][64];
+	extern int psqtEg[2][6][64];
+
+	// https://www.chessprogramming.org/Tapered_Eval
+	// how much every piece counts towards the middlegame
+	// all pieces of the start position add up to MAXPHASE
+	const int phaseWeights[6] = {
+		1, // KNIGHT
+		1, // BISHOP
+		2, // ROOK
+		4, // QUEEN
+		0, // KING
+		0  // PAWN
+	};
+
+	const int MAXPHASE = 24;
+
+	// safe to call more than once, only the first call fills the tables
+	void initPsqt();
+}
+
+#endif // PSQT_H
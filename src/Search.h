@@ -0,0 +1,120 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include "MovePicker.h"
+#include "TranspositionTable.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+namespace Chess {
+
+	// deepest ply the search can reach, sizes the per ply tables
+	const int MAXPLY = 128;
+
+	// scores above MATEBOUND are mates, MATESCORE - ply is mate in ply
+	const int INFINITESCORE = 32001;
+	const int MATESCORE = 32000;
+	const int MATEBOUND = MATESCORE - MAXPLY;
+
+	// https://www.chessprogramming.org/History_Heuristic
+	// the history table is halved when a score gets this high
+	const int HISTORYMAX = 1 << 26;
+
+	// when to stop thinking, zero means no limit
+	struct SearchLimits {
+		int depth = MAXPLY - 1;
+		uint64_t nodes = 0;
+		int64_t movetime = 0; // milliseconds
+		bool printInfo = false; // print every finished iteration
+		int threads = 1; // https://www.chessprogramming.org/Lazy_SMP
+	};
+
+	struct SearchResult {
+		Move bestMove = Move();
+		int score = 0;
+		int depth = 0;
+		uint64_t nodes = 0;
+		int64_t time = 0; // milliseconds
+		MoveList pv; // principal variation, starts with bestMove
+	};
+
+	// https://www.chessprogramming.org/Alpha-Beta
+	// https://www.chessprogramming.org/Iterative_Deepening
+	// negamax alpha-beta search on top of BoardState make/unmake
+	// the board is searched in place and left as it was after think returns
+	// with more than one thread, helpers search copies of the board to the same limits
+	// and share their results only through the transposition table
+	class Search {
+	private:
+		BoardState& board;
+
+		// shared between searches so later moves reuse earlier work
+		TranspositionTable& table;
+
+		SearchLimits limits;
+
+		std::chrono::steady_clock::time_point startTime;
+
+		// written only by the searching thread, read by the main thread for reports
+		std::atomic<uint64_t> nodes;
+
+		// set by stop() from another thread or when a limit is reached
+		std::atomic<bool> stopped;
+
+		// https://www.chessprogramming.org/Triangular_PV-Table
+		// pvTable[ply] holds the best line found from that ply on
+		Move pvTable[MAXPLY][MAXPLY];
+		int pvLength[MAXPLY];
+
+		// best line of the previous iteration, searched first by the next one
+		MoveList previousPv;
+
+		// https://www.chessprogramming.org/Killer_Heuristic
+		// last two quiet moves that caused a beta cutoff at every ply
+		CompactMove killers[MAXPLY][2];
+
+		// https://www.chessprogramming.org/History_Heuristic
+		// how often a quiet move (side, from, to as 0-63 indexes) caused a beta cutoff, weighted by depth
+		int history[2][64][64];
+
+		// pawn structure evaluations of this thread
+		PawnTable pawns;
+
+		// lazy smp helpers of the main search and the boards they search
+		std::vector<std::unique_ptr<BoardState>> helperBoards;
+		std::vector<std::unique_ptr<Search>> helpers;
+
+	private:
+		int negamax(int depth, int ply, int alpha, int beta);
+		// https://www.chessprogramming.org/Quiescence_Search
+		// captures only until the position is quiet, so the horizon is never in the middle of an exchange
+		int quiescence(int ply, int alpha, int beta);
+		// remembers the quiet move that caused the cutoff, searched early in sibling nodes
+		void updateQuietStats(Move move, int ply, int depth);
+		// mate scores are stored relative to the node, not to the root
+		int scoreToTable(int score, int ply);
+		int scoreFromTable(int score, int ply);
+		// checks the node and time limits every few thousand nodes
+		void checkLimits();
+		int64_t elapsed();
+		void printIteration(const SearchResult& result);
+		// resets the counters, returns false if there is no legal move
+		bool prepare(const SearchLimits& searchLimits, SearchResult& result);
+		// iterative deepening loop, firstDepth lets helpers start out of step
+		void iterate(int firstDepth, SearchResult& result);
+		// nodes of this search and all of its helpers
+		uint64_t totalNodes();
+
+	public:
+		Search(BoardState& board, TranspositionTable& table);
+		// iterative deepening until a limit is reached or stop is called
+		// the result always comes from the last completed iteration
+		SearchResult think(const SearchLimits& searchLimits);
+		void stop() { stopped = true; }
+		uint64_t getNodes() { return totalNodes(); }
+	};
+}
+
+#endif // SEARCH_H
@@ -4,6 +4,22 @@ namespace Chess {
 
 	SimpleChess::SimpleChess() {
 		previousState = NOTOVER;
+		computerSide = EMPTY;
+	}
+
+	SimpleChess::SimpleChess(Color computer, SearchLimits limits) {
+		previousState = NOTOVER;
+		computerSide = computer;
+		computerLimits = limits;
+	}
+
+	ValidMove SimpleChess::computerMove() {
+		Search search(board, table);
+		SearchResult result = search.think(computerLimits);
+
+		prompt.computerMoveMsg(result.bestMove);
+
+		return ValidMove(true, result.bestMove);
 	}
 	
 	void SimpleChess::play() {
@@ -26,12 +42,16 @@ namespace Chess {
 			else
 				prompt.invalidMoveMsg();
 
-			pair = prompt.getMove(board.getPlayerColor());
-			vmove = board.findMove(pair);
+			if (board.getPlayerColor() == computerSide)
+				vmove = computerMove();
+			else {
+				pair = prompt.getMove(board.getPlayerColor());
+				vmove = board.findMove(pair);
 
-			if (vmove.first) {
-				if (vmove.second.move.byteData.type & PROMOTE)
-					vmove.second.move.byteData.promote = prompt.getPromotionMove();
+				if (vmove.first) {
+					if (vmove.second.move.byteData.type & PROMOTE)
+						vmove.second.move.byteData.promote = prompt.getPromotionMove();
+				}
 			}
 
 			previousState = board.playNextMove(vmove, previousState);
@@ -0,0 +1,78 @@
+#ifndef TRANSPOSITION_TABLE_H
+#define TRANSPOSITION_TABLE_H
+
+#include "Types.h"
+#include <atomic>
+#include <type_traits>
+
+namespace Chess {
+
+	// what the stored score says about the real score of the position
+	enum Bound : int {
+		BOUNDNONE = 0,
+		BOUNDUPPER = 1, // fail low, real score <= stored score
+		BOUNDLOWER = 2, // fail high, real score >= stored score
+		BOUNDEXACT = BOUNDUPPER | BOUNDLOWER
+	};
+
+	// what is stored for a position, packs into 64 bits
+	struct TTEntry {
+		CompactMove move;
+		int16_t score;
+		int8_t depth;
+		// bound in the low 2 bits, generation of the search in the high 6 bits
+		uint8_t boundAndGeneration;
+		// high 16 bits of the zobrist key, the low bits already chose the bucket
+		uint16_t key;
+
+		int bound() const { return boundAndGeneration & 3; }
+		int generation() const { return boundAndGeneration >> 2; }
+	};
+
+	// https://www.chessprogramming.org/Shared_Hash_Table#Lockless
+	// threads read and write whole entries as one word without locks, a slot can not be torn
+	// 8 bytes, eight of them fill one cache line
+	using TTSlot = std::atomic<uint64_t>;
+
+	// entries with the same bucket index share one cache line
+	struct TTBucket {
+		TTSlot slots[8];
+	};
+
+	// https://www.chessprogramming.org/Transposition_Table
+	// fixed size table indexed by the low bits of the zobrist hash
+	// the number of buckets is a power of two so the index is a mask
+	// safe to share between search threads
+	class TranspositionTable {
+	private:
+		std::vector<char> memory;
+		TTBucket* buckets;
+		size_t bucketMask;
+
+		// incremented by every search, entries of older searches are replaced first
+		uint8_t generation;
+
+	private:
+		static uint64_t pack(const TTEntry& entry);
+		static TTEntry unpack(uint64_t data);
+
+	public:
+		TranspositionTable(size_t megabytes = 16);
+		// rounds down to a power of two buckets, clears the table
+		void resize(size_t megabytes);
+		void clear();
+		void newSearch() { generation = (generation + 1) & 63; }
+
+		// copies the entry for the key and returns true if there is one
+		// with 16 key bits a different position matches once in many thousand probes
+		// so the move is only compared with generated moves, never played unchecked
+		bool probe(BoardStateHash key, TTEntry& entry);
+		void store(BoardStateHash key, CompactMove move, int score, int depth, int bound);
+
+		// https://www.chessprogramming.org/UCI#hashfull
+		// used entries of the current search in permille, from a sample of buckets
+		int hashfull();
+	};
+}
+
+#endif // TRANSPOSITION_TABLE_H